@@ -0,0 +1,876 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyAlgorithm_h_
+#define TinyAlgorithm_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// All algorithms work on raw pointer ranges and on vector iterators.
+	// None of them allocates, except the merge and set operations that write
+	// into a vector, which reserve their output once up front.
+
+	struct less {
+		template <typename A, typename B> bool operator () (A const &a, B const &b) const
+		{
+			return a < b;
+		}
+	};
+
+	// for a min-heap, such as a timer queue ordered by deadline
+	struct greater {
+		template <typename A, typename B> bool operator () (A const &a, B const &b) const
+		{
+			return b < a;
+		}
+	};
+
+	template <typename T> inline T *ptr_of(T *p)
+	{
+		return p;
+	}
+
+	template <typename It> inline auto ptr_of(It const &it) -> decltype(it.get())
+	{
+		return it.get();
+	}
+
+	template <typename T> inline void swap(T &a, T &b)
+	{
+		T t(a);
+		a = b;
+		b = t;
+	}
+
+	namespace detail {
+		enum {
+			INSERTION_SORT_THRESHOLD = 16,
+			MIN_GALLOP = 7, // merge steps won by one side in a row before searching ahead
+			MERGE_N_LOCAL = 16, // merge_n inputs whose heap fits on the stack
+		};
+
+		inline size_t depth_limit(size_t n)
+		{
+			size_t d = 0;
+			while (n > 1) {
+				n >>= 1;
+				d += 2;
+			}
+			return d;
+		}
+
+		template <typename T, typename Compare> void insertion_sort(T *first, T *last, Compare comp)
+		{
+			if (first == last) return;
+			for (T *i = first + 1; i < last; i++) {
+				if (comp(*i, *first)) {
+					T t(*i);
+					for (T *p = i; p > first; p--) {
+						p[0] = p[-1];
+					}
+					*first = t;
+				} else {
+					T t(*i);
+					T *p = i;
+					while (comp(t, p[-1])) {
+						p[0] = p[-1];
+						p--;
+					}
+					*p = t;
+				}
+			}
+		}
+
+		template <typename T, typename Compare> void sift_down(T *first, size_t i, size_t n, Compare comp)
+		{
+			T t(first[i]);
+			while (1) {
+				size_t c = i * 2 + 1;
+				if (c >= n) break;
+				if (c + 1 < n && comp(first[c], first[c + 1])) c++;
+				if (!comp(t, first[c])) break;
+				first[i] = first[c];
+				i = c;
+			}
+			first[i] = t;
+		}
+
+		template <typename T, typename Compare> void sift_up(T *first, size_t i, Compare comp)
+		{
+			T t(first[i]);
+			while (i > 0) {
+				size_t p = (i - 1) / 2;
+				if (!comp(first[p], t)) break;
+				first[i] = first[p];
+				i = p;
+			}
+			first[i] = t;
+		}
+
+		template <typename T, typename Compare> void make_heap(T *first, T *last, Compare comp)
+		{
+			size_t n = last - first;
+			for (size_t i = n / 2; i > 0; i--) {
+				detail::sift_down(first, i - 1, n, comp);
+			}
+		}
+
+		template <typename T, typename Compare> void sort_heap(T *first, T *last, Compare comp)
+		{
+			size_t n = last - first;
+			while (n > 1) {
+				n--;
+				tiny::swap(first[0], first[n]);
+				detail::sift_down(first, 0, n, comp);
+			}
+		}
+
+		template <typename T, typename Compare> void heap_select(T *first, T *middle, T *last, Compare comp)
+		{
+			detail::make_heap(first, middle, comp);
+			size_t n = middle - first;
+			for (T *i = middle; i < last; i++) {
+				if (comp(*i, *first)) {
+					tiny::swap(*i, *first);
+					detail::sift_down(first, 0, n, comp);
+				}
+			}
+		}
+
+		// moves the median of first[1], mid, last[-1] to *first and partitions
+		// the rest around it. returns the start of the right hand side.
+		template <typename T, typename Compare> T *partition_pivot(T *first, T *last, Compare comp)
+		{
+			T *a = first + 1;
+			T *b = first + (last - first) / 2;
+			T *c = last - 1;
+			if (comp(*a, *b)) {
+				if (comp(*b, *c)) {
+					tiny::swap(*first, *b);
+				} else if (comp(*a, *c)) {
+					tiny::swap(*first, *c);
+				} else {
+					tiny::swap(*first, *a);
+				}
+			} else {
+				if (comp(*a, *c)) {
+					tiny::swap(*first, *a);
+				} else if (comp(*b, *c)) {
+					tiny::swap(*first, *c);
+				} else {
+					tiny::swap(*first, *b);
+				}
+			}
+			T *lo = first + 1;
+			T *hi = last;
+			while (1) {
+				while (comp(*lo, *first)) lo++;
+				hi--;
+				while (comp(*first, *hi)) hi--;
+				if (!(lo < hi)) return lo;
+				tiny::swap(*lo, *hi);
+				lo++;
+			}
+		}
+
+		template <typename T, typename Compare> void introsort_loop(T *first, T *last, size_t depth, Compare comp)
+		{
+			while (last - first > INSERTION_SORT_THRESHOLD) {
+				if (depth == 0) {
+					detail::heap_select(first, last, last, comp);
+					detail::sort_heap(first, last, comp);
+					return;
+				}
+				depth--;
+				T *cut = detail::partition_pivot(first, last, comp);
+				// recurse into the smaller half to bound the stack depth
+				if (cut - first < last - cut) {
+					detail::introsort_loop(first, cut, depth, comp);
+					first = cut;
+				} else {
+					detail::introsort_loop(cut, last, depth, comp);
+					last = cut;
+				}
+			}
+		}
+
+		template <typename T, typename Compare> void introsort(T *first, T *last, Compare comp)
+		{
+			if (last - first > 1) {
+				detail::introsort_loop(first, last, depth_limit(last - first), comp);
+				detail::insertion_sort(first, last, comp);
+			}
+		}
+
+		template <typename T, typename Compare> void introselect(T *first, T *nth, T *last, Compare comp)
+		{
+			if (!(nth < last)) return;
+			size_t depth = depth_limit(last - first);
+			while (last - first > INSERTION_SORT_THRESHOLD) {
+				if (depth == 0) {
+					detail::heap_select(first, nth + 1, last, comp);
+					tiny::swap(*first, *nth);
+					return;
+				}
+				depth--;
+				T *cut = detail::partition_pivot(first, last, comp);
+				if (nth < cut) {
+					last = cut;
+				} else {
+					first = cut;
+				}
+			}
+			detail::insertion_sort(first, last, comp);
+		}
+
+		template <typename T, typename V, typename Compare> T *lower_bound(T *first, T *last, V const &v, Compare comp)
+		{
+			size_t n = last - first;
+			while (n > 0) {
+				size_t half = n / 2;
+				if (comp(first[half], v)) {
+					first += half + 1;
+					n -= half + 1;
+				} else {
+					n = half;
+				}
+			}
+			return first;
+		}
+
+		template <typename T, typename V, typename Compare> T *upper_bound(T *first, T *last, V const &v, Compare comp)
+		{
+			size_t n = last - first;
+			while (n > 0) {
+				size_t half = n / 2;
+				if (!comp(v, first[half])) {
+					first += half + 1;
+					n -= half + 1;
+				} else {
+					n = half;
+				}
+			}
+			return first;
+		}
+
+		template <typename T> void reverse(T *first, T *last)
+		{
+			while (first < last) {
+				last--;
+				tiny::swap(*first, *last);
+				first++;
+			}
+		}
+
+		template <typename T> void rotate(T *first, T *middle, T *last)
+		{
+			detail::reverse(first, middle);
+			detail::reverse(middle, last);
+			detail::reverse(first, last);
+		}
+
+		// rotation based merge for when no buffer is available
+		template <typename T, typename Compare> void merge_inplace(T *first, T *middle, T *last, Compare comp)
+		{
+			size_t n1 = middle - first;
+			size_t n2 = last - middle;
+			if (n1 == 0 || n2 == 0) return;
+			if (n1 + n2 == 2) {
+				if (comp(*middle, *first)) tiny::swap(*first, *middle);
+				return;
+			}
+			T *cut1;
+			T *cut2;
+			if (n1 > n2) {
+				cut1 = first + n1 / 2;
+				cut2 = detail::lower_bound(middle, last, *cut1, comp);
+			} else {
+				cut2 = middle + n2 / 2;
+				cut1 = detail::upper_bound(first, middle, *cut2, comp);
+			}
+			detail::rotate(cut1, middle, cut2);
+			T *mid = cut1 + (cut2 - middle);
+			detail::merge_inplace(first, cut1, mid, comp);
+			detail::merge_inplace(mid, cut2, last, comp);
+		}
+
+		// merge using buf, which must hold at least middle - first elements
+		template <typename T, typename Compare> void merge_buffered(T *first, T *middle, T *last, T *buf, Compare comp)
+		{
+			T *b = buf;
+			T *e = buf;
+			for (T *p = first; p < middle; p++) {
+				*e++ = *p;
+			}
+			T *d = first;
+			while (b < e && middle < last) {
+				if (comp(*middle, *b)) {
+					*d++ = *middle++;
+				} else {
+					*d++ = *b++;
+				}
+			}
+			while (b < e) {
+				*d++ = *b++;
+			}
+		}
+
+		// exponential search from first, for inputs where the answer is
+		// usually close by
+		template <typename T, typename V, typename Compare> T *gallop_lower(T *first, T *last, V const &v, Compare comp)
+		{
+			size_t n = last - first;
+			size_t lo = 0;
+			size_t hi = 1;
+			while (hi < n && comp(first[hi], v)) {
+				lo = hi + 1;
+				hi = hi * 2 + 1;
+			}
+			return detail::lower_bound(first + lo, first + (hi < n ? hi : n), v, comp);
+		}
+
+		template <typename T, typename V, typename Compare> T *gallop_upper(T *first, T *last, V const &v, Compare comp)
+		{
+			size_t n = last - first;
+			size_t lo = 0;
+			size_t hi = 1;
+			while (hi < n && !comp(v, first[hi])) {
+				lo = hi + 1;
+				hi = hi * 2 + 1;
+			}
+			return detail::upper_bound(first + lo, first + (hi < n ? hi : n), v, comp);
+		}
+
+		// Where the merge and set operations write to: one(v) for a single
+		// element, run(b, e) for a range.
+		template <typename T> class pointer_sink {
+		private:
+			T *ptr;
+		public:
+			pointer_sink(T *p)
+				: ptr(p)
+			{
+			}
+			void one(T const &v)
+			{
+				*ptr++ = v;
+			}
+			void run(T const *b, T const *e)
+			{
+				while (b < e) {
+					*ptr++ = *b++;
+				}
+			}
+			T *get() const
+			{
+				return ptr;
+			}
+		};
+
+		template <typename V> class vector_sink {
+		private:
+			V *vec;
+		public:
+			vector_sink(V *v)
+				: vec(v)
+			{
+			}
+			template <typename T> void one(T const &v)
+			{
+				vec->push_back(v);
+			}
+			template <typename T> void run(T const *b, T const *e)
+			{
+				if (b < e) {
+					vec->insert(vec->end(), b, e);
+				}
+			}
+		};
+
+		struct null_sink {
+			template <typename T> void one(T const &)
+			{
+			}
+			template <typename T> void run(T const *, T const *)
+			{
+			}
+		};
+
+		// Passes *p, which comes before v, to out and advances p. After
+		// MIN_GALLOP calls in a row for the same side, finds the whole run
+		// before v (or not after it, if upper) by galloping and passes it
+		// on at once.
+		template <typename T, typename Out, typename Compare> void take(T const *&p, T const *e, T const &v, bool upper, size_t &streak, Out &out, Compare comp)
+		{
+			if (++streak < MIN_GALLOP) {
+				out.one(*p++);
+				return;
+			}
+			T const *q = upper ? gallop_upper(p, e, v, comp) : gallop_lower(p, e, v, comp);
+			out.run(p, q);
+			p = q;
+			streak = 0;
+		}
+
+		// stable: of equal elements, those of a come first
+		template <typename T, typename Out, typename Compare> void merge(T const *a, T const *ae, T const *b, T const *be, Out &out, Compare comp)
+		{
+			size_t wa = 0;
+			size_t wb = 0;
+			while (a < ae && b < be) {
+				if (comp(*b, *a)) {
+					wa = 0;
+					take(b, be, *a, false, wb, out, comp);
+				} else {
+					wb = 0;
+					take(a, ae, *b, true, wa, out, comp);
+				}
+			}
+			out.run(a, ae);
+			out.run(b, be);
+		}
+
+		// The set operations treat their inputs as multisets, like the
+		// standard library: an element occurring m times in a and n times
+		// in b occurs max(m, n), min(m, n) or m - n times in the result.
+		template <typename T, typename Out, typename Compare> void set_union(T const *a, T const *ae, T const *b, T const *be, Out &out, Compare comp)
+		{
+			size_t wa = 0;
+			size_t wb = 0;
+			while (a < ae && b < be) {
+				if (comp(*a, *b)) {
+					wb = 0;
+					take(a, ae, *b, false, wa, out, comp);
+				} else if (comp(*b, *a)) {
+					wa = 0;
+					take(b, be, *a, false, wb, out, comp);
+				} else {
+					out.one(*a++);
+					b++;
+					wa = wb = 0;
+				}
+			}
+			out.run(a, ae);
+			out.run(b, be);
+		}
+
+		template <typename T, typename Out, typename Compare> void set_intersection(T const *a, T const *ae, T const *b, T const *be, Out &out, Compare comp)
+		{
+			null_sink skip;
+			size_t wa = 0;
+			size_t wb = 0;
+			while (a < ae && b < be) {
+				if (comp(*a, *b)) {
+					wb = 0;
+					take(a, ae, *b, false, wa, skip, comp);
+				} else if (comp(*b, *a)) {
+					wa = 0;
+					take(b, be, *a, false, wb, skip, comp);
+				} else {
+					out.one(*a++);
+					b++;
+					wa = wb = 0;
+				}
+			}
+		}
+
+		template <typename T, typename Out, typename Compare> void set_difference(T const *a, T const *ae, T const *b, T const *be, Out &out, Compare comp)
+		{
+			null_sink skip;
+			size_t wa = 0;
+			size_t wb = 0;
+			while (a < ae && b < be) {
+				if (comp(*a, *b)) {
+					wb = 0;
+					take(a, ae, *b, false, wa, out, comp);
+				} else if (comp(*b, *a)) {
+					wa = 0;
+					take(b, be, *a, false, wb, skip, comp);
+				} else {
+					a++;
+					b++;
+					wa = wb = 0;
+				}
+			}
+			out.run(a, ae);
+		}
+
+		template <typename T, typename S> bool prepare_output(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out, size_t bound)
+		{
+			TINY_CHECK(&out != &a && &out != &b, "merge or set operation into one of its inputs");
+			(void)a;
+			(void)b;
+			out.clear();
+			return out.try_reserve(bound);
+		}
+
+		// position in one input of merge_n
+		template <typename T> struct merge_cursor {
+			T const *ptr;
+			T const *end;
+			size_t src;
+		};
+
+		// x comes out after y; ties go by input order, keeping merge_n stable
+		template <typename T, typename Compare> struct merge_cursor_after {
+			Compare comp;
+			merge_cursor_after(Compare comp)
+				: comp(comp)
+			{
+			}
+			bool operator () (merge_cursor<T> const &x, merge_cursor<T> const &y) const
+			{
+				return comp(*y.ptr, *x.ptr) || (!comp(*x.ptr, *y.ptr) && x.src > y.src);
+			}
+		};
+
+		// heap holds the n non-empty inputs. The input on top of the heap
+		// passes on its whole run up to the head of the next one at once.
+		template <typename T, typename Out, typename Compare> void merge_n(merge_cursor<T> *heap, size_t n, Out &out, Compare comp)
+		{
+			merge_cursor_after<T, Compare> after(comp);
+			detail::make_heap(heap, heap + n, after);
+			while (n > 1) {
+				merge_cursor<T> &top = heap[0];
+				merge_cursor<T> const *next = &heap[1];
+				if (n > 2 && after(heap[1], heap[2])) {
+					next = &heap[2];
+				}
+				// on interleaved inputs most runs are one element; check
+				// the second before galloping for the rest
+				bool upper = top.src < next->src;
+				T const *q = top.ptr + 1;
+				if (q < top.end && (upper ? !comp(*next->ptr, *q) : comp(*q, *next->ptr))) {
+					q = upper ? gallop_upper(q + 1, top.end, *next->ptr, comp) : gallop_lower(q + 1, top.end, *next->ptr, comp);
+					out.run(top.ptr, q);
+				} else {
+					out.one(*top.ptr);
+				}
+				top.ptr = q;
+				if (q == top.end) {
+					n--;
+					heap[0] = heap[n];
+				}
+				detail::sift_down(heap, 0, n, after);
+			}
+			if (n == 1) {
+				out.run(heap[0].ptr, heap[0].end);
+			}
+		}
+
+		template <typename T, typename Compare> void merge_sort(T *first, T *last, T *buf, Compare comp)
+		{
+			if (last - first <= INSERTION_SORT_THRESHOLD) {
+				detail::insertion_sort(first, last, comp);
+				return;
+			}
+			T *middle = first + (last - first) / 2;
+			detail::merge_sort(first, middle, buf, comp);
+			detail::merge_sort(middle, last, buf, comp);
+			if (!comp(*middle, middle[-1])) return;
+			if (buf) {
+				detail::merge_buffered(first, middle, last, buf, comp);
+			} else {
+				detail::merge_inplace(first, middle, last, comp);
+			}
+		}
+	}
+
+	template <typename It, typename Compare> inline void sort(It first, It last, Compare comp)
+	{
+		detail::introsort(ptr_of(first), ptr_of(last), comp);
+	}
+
+	template <typename It> inline void sort(It first, It last)
+	{
+		tiny::sort(first, last, less());
+	}
+
+	// stable_sort without a buffer merges in place in O(n log^2 n).
+	// with a buffer of at least (last - first + 1) / 2 elements it is O(n log n).
+	template <typename It, typename T, typename Compare> inline void stable_sort(It first, It last, T *buffer, Compare comp)
+	{
+		detail::merge_sort(ptr_of(first), ptr_of(last), buffer, comp);
+	}
+
+	template <typename It, typename Compare> inline void stable_sort(It first, It last, Compare comp)
+	{
+		detail::merge_sort(ptr_of(first), ptr_of(last), decltype(ptr_of(first))(0), comp);
+	}
+
+	template <typename It> inline void stable_sort(It first, It last)
+	{
+		tiny::stable_sort(first, last, less());
+	}
+
+	template <typename It, typename Compare> inline void partial_sort(It first, It middle, It last, Compare comp)
+	{
+		detail::heap_select(ptr_of(first), ptr_of(middle), ptr_of(last), comp);
+		detail::sort_heap(ptr_of(first), ptr_of(middle), comp);
+	}
+
+	template <typename It> inline void partial_sort(It first, It middle, It last)
+	{
+		tiny::partial_sort(first, middle, last, less());
+	}
+
+	template <typename It, typename Compare> inline void nth_element(It first, It nth, It last, Compare comp)
+	{
+		detail::introselect(ptr_of(first), ptr_of(nth), ptr_of(last), comp);
+	}
+
+	template <typename It> inline void nth_element(It first, It nth, It last)
+	{
+		tiny::nth_element(first, nth, last, less());
+	}
+
+	template <typename It, typename Compare> inline void make_heap(It first, It last, Compare comp)
+	{
+		detail::make_heap(ptr_of(first), ptr_of(last), comp);
+	}
+
+	template <typename It> inline void make_heap(It first, It last)
+	{
+		tiny::make_heap(first, last, less());
+	}
+
+	// last[-1] is the element to be added to the heap [first, last - 1)
+	template <typename It, typename Compare> inline void push_heap(It first, It last, Compare comp)
+	{
+		size_t n = ptr_of(last) - ptr_of(first);
+		if (n > 1) {
+			detail::sift_up(ptr_of(first), n - 1, comp);
+		}
+	}
+
+	template <typename It> inline void push_heap(It first, It last)
+	{
+		tiny::push_heap(first, last, less());
+	}
+
+	// moves the top of the heap to last[-1]
+	template <typename It, typename Compare> inline void pop_heap(It first, It last, Compare comp)
+	{
+		size_t n = ptr_of(last) - ptr_of(first);
+		if (n > 1) {
+			tiny::swap(ptr_of(first)[0], ptr_of(first)[n - 1]);
+			detail::sift_down(ptr_of(first), 0, n - 1, comp);
+		}
+	}
+
+	template <typename It> inline void pop_heap(It first, It last)
+	{
+		tiny::pop_heap(first, last, less());
+	}
+
+	template <typename It, typename Compare> inline void sort_heap(It first, It last, Compare comp)
+	{
+		detail::sort_heap(ptr_of(first), ptr_of(last), comp);
+	}
+
+	template <typename It> inline void sort_heap(It first, It last)
+	{
+		tiny::sort_heap(first, last, less());
+	}
+
+	template <typename It, typename V, typename Compare> inline It lower_bound(It first, It last, V const &v, Compare comp)
+	{
+		size_t n = detail::lower_bound(ptr_of(first), ptr_of(last), v, comp) - ptr_of(first);
+		return n > 0 ? first + n : first;
+	}
+
+	template <typename It, typename V> inline It lower_bound(It first, It last, V const &v)
+	{
+		return tiny::lower_bound(first, last, v, less());
+	}
+
+	template <typename It, typename V, typename Compare> inline It upper_bound(It first, It last, V const &v, Compare comp)
+	{
+		size_t n = detail::upper_bound(ptr_of(first), ptr_of(last), v, comp) - ptr_of(first);
+		return n > 0 ? first + n : first;
+	}
+
+	template <typename It, typename V> inline It upper_bound(It first, It last, V const &v)
+	{
+		return tiny::upper_bound(first, last, v, less());
+	}
+
+	template <typename It, typename V, typename Compare> inline bool binary_search(It first, It last, V const &v, Compare comp)
+	{
+		auto p = detail::lower_bound(ptr_of(first), ptr_of(last), v, comp);
+		return p < ptr_of(last) && !comp(v, *p);
+	}
+
+	template <typename It, typename V> inline bool binary_search(It first, It last, V const &v)
+	{
+		return tiny::binary_search(first, last, v, less());
+	}
+
+	// Merge and set operations over sorted ranges. The range versions write
+	// to out, which must have room for the result, and return the end of
+	// what they wrote. The vector versions replace the contents of out,
+	// reserving for the largest possible result once, and return false,
+	// leaving out empty, if that fails. out must not be one of the inputs.
+
+	template <typename It, typename T, typename Compare> inline T *merge(It a, It ae, It b, It be, T *out, Compare comp)
+	{
+		detail::pointer_sink<T> sink(out);
+		detail::merge(ptr_of(a), ptr_of(ae), ptr_of(b), ptr_of(be), sink, comp);
+		return sink.get();
+	}
+
+	template <typename It, typename T> inline T *merge(It a, It ae, It b, It be, T *out)
+	{
+		return tiny::merge(a, ae, b, be, out, less());
+	}
+
+	template <typename T, typename S, typename Compare> inline bool merge(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out, Compare comp)
+	{
+		if (!detail::prepare_output(a, b, out, a.size() + b.size())) {
+			return false;
+		}
+		detail::vector_sink<vector<T, S> > sink(&out);
+		detail::merge(ptr_of(a.begin()), ptr_of(a.end()), ptr_of(b.begin()), ptr_of(b.end()), sink, comp);
+		return true;
+	}
+
+	template <typename T, typename S> inline bool merge(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out)
+	{
+		return tiny::merge(a, b, out, less());
+	}
+
+	template <typename It, typename T, typename Compare> inline T *set_union(It a, It ae, It b, It be, T *out, Compare comp)
+	{
+		detail::pointer_sink<T> sink(out);
+		detail::set_union(ptr_of(a), ptr_of(ae), ptr_of(b), ptr_of(be), sink, comp);
+		return sink.get();
+	}
+
+	template <typename It, typename T> inline T *set_union(It a, It ae, It b, It be, T *out)
+	{
+		return tiny::set_union(a, ae, b, be, out, less());
+	}
+
+	template <typename T, typename S, typename Compare> inline bool set_union(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out, Compare comp)
+	{
+		if (!detail::prepare_output(a, b, out, a.size() + b.size())) {
+			return false;
+		}
+		detail::vector_sink<vector<T, S> > sink(&out);
+		detail::set_union(ptr_of(a.begin()), ptr_of(a.end()), ptr_of(b.begin()), ptr_of(b.end()), sink, comp);
+		return true;
+	}
+
+	template <typename T, typename S> inline bool set_union(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out)
+	{
+		return tiny::set_union(a, b, out, less());
+	}
+
+	template <typename It, typename T, typename Compare> inline T *set_intersection(It a, It ae, It b, It be, T *out, Compare comp)
+	{
+		detail::pointer_sink<T> sink(out);
+		detail::set_intersection(ptr_of(a), ptr_of(ae), ptr_of(b), ptr_of(be), sink, comp);
+		return sink.get();
+	}
+
+	template <typename It, typename T> inline T *set_intersection(It a, It ae, It b, It be, T *out)
+	{
+		return tiny::set_intersection(a, ae, b, be, out, less());
+	}
+
+	template <typename T, typename S, typename Compare> inline bool set_intersection(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out, Compare comp)
+	{
+		if (!detail::prepare_output(a, b, out, a.size() < b.size() ? a.size() : b.size())) {
+			return false;
+		}
+		detail::vector_sink<vector<T, S> > sink(&out);
+		detail::set_intersection(ptr_of(a.begin()), ptr_of(a.end()), ptr_of(b.begin()), ptr_of(b.end()), sink, comp);
+		return true;
+	}
+
+	template <typename T, typename S> inline bool set_intersection(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out)
+	{
+		return tiny::set_intersection(a, b, out, less());
+	}
+
+	template <typename It, typename T, typename Compare> inline T *set_difference(It a, It ae, It b, It be, T *out, Compare comp)
+	{
+		detail::pointer_sink<T> sink(out);
+		detail::set_difference(ptr_of(a), ptr_of(ae), ptr_of(b), ptr_of(be), sink, comp);
+		return sink.get();
+	}
+
+	template <typename It, typename T> inline T *set_difference(It a, It ae, It b, It be, T *out)
+	{
+		return tiny::set_difference(a, ae, b, be, out, less());
+	}
+
+	template <typename T, typename S, typename Compare> inline bool set_difference(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out, Compare comp)
+	{
+		if (!detail::prepare_output(a, b, out, a.size())) {
+			return false;
+		}
+		detail::vector_sink<vector<T, S> > sink(&out);
+		detail::set_difference(ptr_of(a.begin()), ptr_of(a.end()), ptr_of(b.begin()), ptr_of(b.end()), sink, comp);
+		return true;
+	}
+
+	template <typename T, typename S> inline bool set_difference(vector<T, S> const &a, vector<T, S> const &b, vector<T, S> &out)
+	{
+		return tiny::set_difference(a, b, out, less());
+	}
+
+	// k-way merge of k sorted vectors, stable across inputs
+	template <typename T, typename S, typename Compare> bool merge_n(vector<T, S> const *in, size_t k, vector<T, S> &out, Compare comp)
+	{
+		size_t total = 0;
+		for (size_t i = 0; i < k; i++) {
+			TINY_CHECK(&in[i] != &out, "merge_n into one of its inputs");
+			total += in[i].size();
+		}
+		out.clear();
+		detail::merge_cursor<T> local[detail::MERGE_N_LOCAL];
+		vector<detail::merge_cursor<T> > spill;
+		detail::merge_cursor<T> *heap = local;
+		if (k > detail::MERGE_N_LOCAL) {
+			spill.resize(k);
+			if (spill.size() != k) {
+				return false;
+			}
+			heap = &spill[0];
+		}
+		if (!out.try_reserve(total)) {
+			return false;
+		}
+		size_t n = 0;
+		for (size_t i = 0; i < k; i++) {
+			if (!in[i].empty()) {
+				detail::merge_cursor<T> c = { ptr_of(in[i].begin()), ptr_of(in[i].end()), i };
+				heap[n++] = c;
+			}
+		}
+		detail::vector_sink<vector<T, S> > sink(&out);
+		detail::merge_n(heap, n, sink, comp);
+		return true;
+	}
+
+	template <typename T, typename S> bool merge_n(vector<T, S> const *in, size_t k, vector<T, S> &out)
+	{
+		return tiny::merge_n(in, k, out, less());
+	}
+
+	template <typename T, typename S, typename S2, typename Compare> bool merge_n(vector<vector<T, S>, S2> const &in, vector<T, S> &out, Compare comp)
+	{
+		return tiny::merge_n(in.empty() ? (vector<T, S> const *)0 : &in[0], in.size(), out, comp);
+	}
+
+	template <typename T, typename S, typename S2> bool merge_n(vector<vector<T, S>, S2> const &in, vector<T, S> &out)
+	{
+		return tiny::merge_n(in, out, less());
+	}
+
+} // namespace tiny
+
+#endif
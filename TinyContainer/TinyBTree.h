@@ -0,0 +1,661 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyBTree_h_
+#define TinyBTree_h_
+
+#include "TinyAlgorithm.h"
+
+namespace tiny {
+
+	// Nodes are obtained from an allocator object with
+	//   void *allocate(size_t bytes); // null if out of memory
+	//   void deallocate(void *p, size_t bytes);
+	// Every node of one tree type has one of two sizes, so a pair of
+	// fixed block pools is enough to serve a tree without touching the heap.
+	struct default_node_allocator {
+		void *allocate(size_t n)
+		{
+			return detail::allocate_bytes(n);
+		}
+		void deallocate(void *p, size_t)
+		{
+			detail::free_bytes(p);
+		}
+	};
+
+	template <typename K, typename V> struct map_entry {
+		K key;
+		V value;
+		map_entry()
+		{
+		}
+		map_entry(K const &k, V const &v)
+			: key(k)
+			, value(v)
+		{
+		}
+	};
+
+	namespace detail {
+		template <typename K> struct set_key_of {
+			static K const &key(K const &k)
+			{
+				return k;
+			}
+		};
+		template <typename K, typename V> struct map_key_of {
+			static K const &key(map_entry<K, V> const &e)
+			{
+				return e.key;
+			}
+		};
+	}
+
+	// B+tree: all elements live in the leaves, which are chained for
+	// iteration; inner nodes only hold separator keys. NodeBytes sets the
+	// target node size from which the fanout is derived. Erase removes
+	// nodes only once they are empty instead of rebalancing, which keeps
+	// it simple and never allocates. An empty tree holds no nodes, and an
+	// insert that runs out of memory leaves the tree as it was.
+	template <typename K, typename Slot, typename KeyOf, typename Compare, size_t NodeBytes, typename Alloc> class btree {
+	private:
+		struct node_t {
+			unsigned short count;
+			bool leaf;
+		};
+		enum {
+			LEAF_FIT = (NodeBytes - sizeof(node_t) - 2 * sizeof(void *)) / sizeof(Slot),
+			INNER_FIT = (NodeBytes - sizeof(node_t) - sizeof(void *)) / (sizeof(K) + sizeof(void *)),
+			LEAF_N = LEAF_FIT > 3 ? LEAF_FIT : 3,
+			INNER_N = INNER_FIT > 3 ? INNER_FIT : 3,
+			MAX_DEPTH = 32,
+		};
+		struct leaf_t : node_t {
+			leaf_t *prev;
+			leaf_t *next;
+			Slot slots[LEAF_N];
+		};
+		struct inner_t : node_t {
+			K keys[INNER_N];
+			node_t *children[INNER_N + 1];
+		};
+		node_t *root;
+		leaf_t *head;
+		size_t count;
+		Compare comp;
+		Alloc alloc;
+
+		static K const &key_of(Slot const &s)
+		{
+			return KeyOf::key(s);
+		}
+		bool equal(K const &a, K const &b) const
+		{
+			return !comp(a, b) && !comp(b, a);
+		}
+		leaf_t *new_leaf()
+		{
+			void *m = alloc.allocate(sizeof(leaf_t));
+			if (!m) {
+				return 0;
+			}
+			leaf_t *p = new(m) leaf_t();
+			p->count = 0;
+			p->leaf = true;
+			p->prev = 0;
+			p->next = 0;
+			return p;
+		}
+		inner_t *new_inner()
+		{
+			void *m = alloc.allocate(sizeof(inner_t));
+			if (!m) {
+				return 0;
+			}
+			inner_t *p = new(m) inner_t();
+			p->count = 0;
+			p->leaf = false;
+			return p;
+		}
+		void delete_node(node_t *n)
+		{
+			if (n->leaf) {
+				((leaf_t *)n)->~leaf_t();
+				alloc.deallocate(n, sizeof(leaf_t));
+			} else {
+				((inner_t *)n)->~inner_t();
+				alloc.deallocate(n, sizeof(inner_t));
+			}
+		}
+		// frees the chain of leaves from head, before any inner node
+		// refers to them
+		void clear_leaves()
+		{
+			while (head) {
+				leaf_t *next = head->next;
+				delete_node(head);
+				head = next;
+			}
+			root = 0;
+			count = 0;
+		}
+		void delete_tree(node_t *n)
+		{
+			if (!n) {
+				return;
+			}
+			if (!n->leaf) {
+				inner_t *in = (inner_t *)n;
+				for (size_t i = 0; i <= in->count; i++) {
+					delete_tree(in->children[i]);
+				}
+			}
+			delete_node(n);
+		}
+		size_t leaf_lower(leaf_t const *l, K const &k) const
+		{
+			size_t lo = 0;
+			size_t hi = l->count;
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+				if (comp(key_of(l->slots[mid]), k)) lo = mid + 1; else hi = mid;
+			}
+			return lo;
+		}
+		size_t leaf_upper(leaf_t const *l, K const &k) const
+		{
+			size_t lo = 0;
+			size_t hi = l->count;
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+				if (!comp(k, key_of(l->slots[mid]))) lo = mid + 1; else hi = mid;
+			}
+			return lo;
+		}
+		// child of an inner node that covers k
+		size_t child_index(inner_t const *in, K const &k) const
+		{
+			size_t lo = 0;
+			size_t hi = in->count;
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+				if (!comp(k, in->keys[mid])) lo = mid + 1; else hi = mid;
+			}
+			return lo;
+		}
+		leaf_t *find_leaf(K const &k, inner_t **path, size_t *index, size_t *depth) const
+		{
+			node_t *n = root;
+			size_t d = 0;
+			while (!n->leaf) {
+				inner_t *in = (inner_t *)n;
+				size_t i = child_index(in, k);
+				if (path) {
+					path[d] = in;
+					index[d] = i;
+				}
+				d++;
+				n = in->children[i];
+			}
+			if (depth) *depth = d;
+			return (leaf_t *)n;
+		}
+		K const &min_key(node_t const *n) const
+		{
+			while (!n->leaf) n = ((inner_t const *)n)->children[0];
+			return key_of(((leaf_t const *)n)->slots[0]);
+		}
+		static void leaf_insert_at(leaf_t *l, size_t pos, Slot const &s)
+		{
+			for (size_t i = l->count; i > pos; i--) {
+				l->slots[i] = l->slots[i - 1];
+			}
+			l->slots[pos] = s;
+			l->count++;
+		}
+		static void inner_insert_at(inner_t *in, size_t pos, K const &k, node_t *right)
+		{
+			for (size_t i = in->count; i > pos; i--) {
+				in->keys[i] = in->keys[i - 1];
+				in->children[i + 1] = in->children[i];
+			}
+			in->keys[pos] = k;
+			in->children[pos + 1] = right;
+			in->count++;
+		}
+		// adds separator k with right child after children[pos] of path[d],
+		// splitting upwards as needed. The nodes for the splits are taken
+		// from spare, which insert_slot has filled.
+		void insert_separator(inner_t **path, size_t *index, size_t d, K k, node_t *right, inner_t **spare)
+		{
+			while (d > 0) {
+				d--;
+				inner_t *in = path[d];
+				size_t pos = index[d];
+				if (in->count < INNER_N) {
+					inner_insert_at(in, pos, k, right);
+					return;
+				}
+				size_t mid = in->count / 2;
+				inner_t *sib = *spare++;
+				K up = in->keys[mid];
+				size_t j = 0;
+				for (size_t i = mid + 1; i < in->count; i++, j++) {
+					sib->keys[j] = in->keys[i];
+					sib->children[j] = in->children[i];
+				}
+				sib->children[j] = in->children[in->count];
+				sib->count = (unsigned short)j;
+				in->count = (unsigned short)mid;
+				if (pos <= mid) {
+					inner_insert_at(in, pos, k, right);
+				} else {
+					inner_insert_at(sib, pos - mid - 1, k, right);
+				}
+				k = up;
+				right = sib;
+			}
+			inner_t *r = *spare;
+			r->keys[0] = k;
+			r->children[0] = root;
+			r->children[1] = right;
+			r->count = 1;
+			root = r;
+		}
+		// removes children[pos] of path[d], and the node itself if it ends
+		// up without children
+		void remove_child(inner_t **path, size_t *index, size_t d)
+		{
+			while (d > 0) {
+				d--;
+				inner_t *in = path[d];
+				size_t pos = index[d];
+				if (in->count > 0) {
+					size_t kpos = pos > 0 ? pos - 1 : 0;
+					for (size_t i = kpos; i + 1 < in->count; i++) {
+						in->keys[i] = in->keys[i + 1];
+					}
+					for (size_t i = pos; i < in->count; i++) {
+						in->children[i] = in->children[i + 1];
+					}
+					in->count--;
+					break;
+				}
+				if (d == 0) {
+					// the root lost its last child
+					delete_node(in);
+					root = head = 0;
+					return;
+				}
+				delete_node(in);
+			}
+			while (!root->leaf && root->count == 0) {
+				node_t *n = ((inner_t *)root)->children[0];
+				delete_node(root);
+				root = n;
+			}
+		}
+	public:
+		class iterator {
+			friend class btree;
+		private:
+			leaf_t *node;
+			size_t pos;
+		public:
+			iterator(leaf_t *node = 0, size_t pos = 0)
+				: node(node)
+				, pos(pos)
+			{
+				if (node && pos >= node->count) {
+					this->node = node->next;
+					this->pos = 0;
+				}
+			}
+			bool operator == (iterator const &it) const
+			{
+				return node == it.node && pos == it.pos;
+			}
+			bool operator != (iterator const &it) const
+			{
+				return !operator == (it);
+			}
+			void operator ++ ()
+			{
+				if (node && ++pos >= node->count) {
+					node = node->next;
+					pos = 0;
+				}
+			}
+			void operator ++ (int)
+			{
+				operator ++ ();
+			}
+			K const &key() const
+			{
+				return key_of(node->slots[pos]);
+			}
+			// the key must not be modified through these
+			Slot &operator * () const
+			{
+				return node->slots[pos];
+			}
+			Slot *operator -> () const
+			{
+				return &node->slots[pos];
+			}
+		};
+		typedef iterator const_iterator;
+
+		btree(Compare const &comp = Compare(), Alloc const &alloc = Alloc())
+			: root(0)
+			, head(0)
+			, count(0)
+			, comp(comp)
+			, alloc(alloc)
+		{
+		}
+		btree(btree const &r)
+			: root(0)
+			, head(0)
+			, count(0)
+			, comp(r.comp)
+			, alloc(r.alloc)
+		{
+			bulk_load(r.begin(), r.end());
+		}
+		~btree()
+		{
+			delete_tree(root);
+		}
+		void operator = (btree const &r)
+		{
+			if (&r != this) {
+				bulk_load(r.begin(), r.end());
+			}
+		}
+		size_t size() const
+		{
+			return count;
+		}
+		bool empty() const
+		{
+			return count == 0;
+		}
+		void clear()
+		{
+			delete_tree(root);
+			root = head = 0;
+			count = 0;
+		}
+		iterator begin() const
+		{
+			return iterator(head, 0);
+		}
+		iterator end() const
+		{
+			return iterator();
+		}
+		iterator lower_bound(K const &k) const
+		{
+			if (!root) return end();
+			leaf_t *l = find_leaf(k, 0, 0, 0);
+			return iterator(l, leaf_lower(l, k));
+		}
+		iterator upper_bound(K const &k) const
+		{
+			if (!root) return end();
+			leaf_t *l = find_leaf(k, 0, 0, 0);
+			return iterator(l, leaf_upper(l, k));
+		}
+		iterator find(K const &k) const
+		{
+			iterator it = lower_bound(k);
+			if (it != end() && equal(it.key(), k)) return it;
+			return end();
+		}
+		bool contains(K const &k) const
+		{
+			return find(k) != end();
+		}
+		// inserts s unless its key is present already. returns the element
+		// with that key, and sets *inserted if given. If memory runs out
+		// returns end(), with *inserted false, and the tree is unchanged.
+		iterator insert_slot(Slot const &s, bool *inserted = 0)
+		{
+			if (inserted) *inserted = false;
+			if (!root) {
+				root = head = new_leaf();
+				if (!root) return end();
+			}
+			K const &k = key_of(s);
+			inner_t *path[MAX_DEPTH];
+			size_t index[MAX_DEPTH];
+			size_t depth;
+			leaf_t *l = find_leaf(k, path, index, &depth);
+			size_t pos = leaf_lower(l, k);
+			if (pos < l->count && equal(key_of(l->slots[pos]), k)) {
+				return iterator(l, pos);
+			}
+			if (l->count < LEAF_N) {
+				if (inserted) *inserted = true;
+				count++;
+				leaf_insert_at(l, pos, s);
+				return iterator(l, pos);
+			}
+			// the split goes up through every full inner node on the path,
+			// and past the root if they all are. get all the nodes first.
+			size_t ninner = 0;
+			size_t d = depth;
+			while (d > 0 && path[d - 1]->count >= INNER_N) {
+				d--;
+				ninner++;
+			}
+			if (d == 0) {
+				ninner++;
+			}
+			inner_t *spare[MAX_DEPTH + 1];
+			size_t nspare = 0;
+			leaf_t *sib = new_leaf();
+			while (sib && nspare < ninner && (spare[nspare] = new_inner()) != 0) {
+				nspare++;
+			}
+			if (!sib || nspare < ninner) {
+				while (nspare > 0) {
+					delete_node(spare[--nspare]);
+				}
+				if (sib) delete_node(sib);
+				return end();
+			}
+			if (inserted) *inserted = true;
+			count++;
+			size_t mid = l->count / 2;
+			for (size_t i = mid; i < l->count; i++) {
+				sib->slots[i - mid] = l->slots[i];
+			}
+			sib->count = (unsigned short)(l->count - mid);
+			l->count = (unsigned short)mid;
+			sib->next = l->next;
+			sib->prev = l;
+			if (l->next) l->next->prev = sib;
+			l->next = sib;
+			iterator it;
+			if (pos <= mid) {
+				leaf_insert_at(l, pos, s);
+				it = iterator(l, pos);
+			} else {
+				leaf_insert_at(sib, pos - mid, s);
+				it = iterator(sib, pos - mid);
+			}
+			insert_separator(path, index, depth, key_of(sib->slots[0]), sib, spare);
+			return it;
+		}
+		bool erase(K const &k)
+		{
+			if (!root) return false;
+			inner_t *path[MAX_DEPTH];
+			size_t index[MAX_DEPTH];
+			size_t depth;
+			leaf_t *l = find_leaf(k, path, index, &depth);
+			size_t pos = leaf_lower(l, k);
+			if (pos >= l->count || !equal(key_of(l->slots[pos]), k)) {
+				return false;
+			}
+			for (size_t i = pos; i + 1 < l->count; i++) {
+				l->slots[i] = l->slots[i + 1];
+			}
+			l->count--;
+			count--;
+			if (l->count == 0 && depth > 0) {
+				if (l->prev) l->prev->next = l->next; else head = l->next;
+				if (l->next) l->next->prev = l->prev;
+				delete_node(l);
+				remove_child(path, index, depth);
+			}
+			return true;
+		}
+		void erase(iterator it)
+		{
+			erase(K(it.key()));
+		}
+		// replaces the contents with [first, last), which must be sorted by
+		// key. leaves are filled completely and later duplicates are dropped.
+		// false, leaving the tree empty, if memory runs out.
+		template <typename It> bool bulk_load(It first, It last)
+		{
+			clear();
+			leaf_t *l = 0;
+			size_t nleaves = 0;
+			for (It it = first; it != last; it++) {
+				Slot const &s = *it;
+				if (count > 0 && !comp(key_of(l->slots[l->count - 1]), key_of(s))) {
+					continue;
+				}
+				if (!l || l->count == LEAF_N) {
+					leaf_t *n = new_leaf();
+					if (!n) {
+						clear_leaves();
+						return false;
+					}
+					if (l) {
+						n->prev = l;
+						l->next = n;
+					} else {
+						head = n;
+					}
+					l = n;
+					nleaves++;
+				}
+				l->slots[l->count++] = s;
+				count++;
+			}
+			if (!head) {
+				return true;
+			}
+			// build the inner levels bottom up. each level's parents are
+			// written over the front of the level, whose nodes they have
+			// already taken.
+			vector<node_t *> level;
+			if (!level.try_reserve(nleaves)) {
+				clear_leaves();
+				return false;
+			}
+			for (leaf_t *p = head; p; p = p->next) {
+				level.push_back(p);
+			}
+			while (level.size() > 1) {
+				size_t np = 0;
+				inner_t *parent = 0;
+				for (size_t i = 0; i < level.size(); i++) {
+					node_t *n = level[i];
+					if (!parent || parent->count == INNER_N) {
+						parent = new_inner();
+						if (!parent) {
+							// level[0, np) own everything before i
+							for (size_t j = 0; j < np; j++) {
+								delete_tree(level[j]);
+							}
+							for (size_t j = i; j < level.size(); j++) {
+								delete_tree(level[j]);
+							}
+							root = head = 0;
+							count = 0;
+							return false;
+						}
+						parent->children[0] = n;
+						level[np++] = parent;
+					} else {
+						inner_insert_at(parent, parent->count, min_key(n), n);
+					}
+				}
+				level.resize(np);
+			}
+			root = level[0];
+			return true;
+		}
+	};
+
+	template <typename K, typename V, typename Compare = less, size_t NodeBytes = 256, typename Alloc = default_node_allocator> class btree_map : public btree<K, map_entry<K, V>, detail::map_key_of<K, V>, Compare, NodeBytes, Alloc> {
+	private:
+		typedef btree<K, map_entry<K, V>, detail::map_key_of<K, V>, Compare, NodeBytes, Alloc> base;
+	public:
+		typedef map_entry<K, V> entry_t;
+		typedef typename base::iterator iterator;
+		btree_map(Compare const &comp = Compare(), Alloc const &alloc = Alloc())
+			: base(comp, alloc)
+		{
+		}
+		// returns false if the key was present, its value is left alone
+		// then, or if memory ran out
+		bool insert(K const &k, V const &v)
+		{
+			bool inserted;
+			base::insert_slot(entry_t(k, v), &inserted);
+			return inserted;
+		}
+		// inserts or overwrites
+		void set(K const &k, V const &v)
+		{
+			bool inserted;
+			iterator it = base::insert_slot(entry_t(k, v), &inserted);
+			if (!inserted && it != base::end()) it->value = v;
+		}
+		// if memory runs out, refers to a scratch value outside the map
+		V &operator [] (K const &k)
+		{
+			iterator it = base::insert_slot(entry_t(k, V()));
+			if (it == base::end()) {
+				static V scratch;
+				scratch = V();
+				return scratch;
+			}
+			return it->value;
+		}
+		// returns null if the key is not present
+		V *get(K const &k) const
+		{
+			iterator it = base::find(k);
+			return it != base::end() ? &it->value : 0;
+		}
+	};
+
+	template <typename K, typename Compare = less, size_t NodeBytes = 256, typename Alloc = default_node_allocator> class btree_set : public btree<K, K, detail::set_key_of<K>, Compare, NodeBytes, Alloc> {
+	private:
+		typedef btree<K, K, detail::set_key_of<K>, Compare, NodeBytes, Alloc> base;
+	public:
+		btree_set(Compare const &comp = Compare(), Alloc const &alloc = Alloc())
+			: base(comp, alloc)
+		{
+		}
+		// returns false if the key was present or memory ran out
+		bool insert(K const &k)
+		{
+			bool inserted;
+			base::insert_slot(k, &inserted);
+			return inserted;
+		}
+	};
+
+} // namespace tiny
+
+#endif
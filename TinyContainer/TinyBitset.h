@@ -0,0 +1,476 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyBitset_h_
+#define TinyBitset_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Bits are packed into 64-bit words. Bits past size() in the last word
+	// are always kept zero so that the word kernels need no masking.
+	namespace bits {
+		typedef uint64_t word_t;
+
+		enum {
+			WORD_BITS = 64
+		};
+
+		static const size_t npos = (size_t)-1;
+
+		inline size_t words_for(size_t n)
+		{
+			return (n + WORD_BITS - 1) / WORD_BITS;
+		}
+
+		inline word_t bit(size_t i)
+		{
+			return (word_t)1 << (i % WORD_BITS);
+		}
+
+		// bits [i % 64, 64) of a word
+		inline word_t mask_from(size_t i)
+		{
+			return ~(word_t)0 << (i % WORD_BITS);
+		}
+
+		// bits [0, n % 64) of a word, or all of them if n is a multiple of 64
+		inline word_t mask_below(size_t n)
+		{
+			return n % WORD_BITS ? ~mask_from(n) : ~(word_t)0;
+		}
+
+		inline size_t popcount(word_t w)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_popcountll(w);
+#else
+			w = w - ((w >> 1) & 0x5555555555555555ULL);
+			w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+			w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+			return (size_t)((w * 0x0101010101010101ULL) >> 56);
+#endif
+		}
+
+		// index of the lowest set bit; w must not be zero
+		inline size_t ctz(word_t w)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_ctzll(w);
+#else
+			size_t n = 0;
+			if (!(w & 0xffffffffULL)) { n += 32; w >>= 32; }
+			if (!(w & 0xffffULL)) { n += 16; w >>= 16; }
+			if (!(w & 0xffULL)) { n += 8; w >>= 8; }
+			if (!(w & 0xfULL)) { n += 4; w >>= 4; }
+			if (!(w & 0x3ULL)) { n += 2; w >>= 2; }
+			if (!(w & 0x1ULL)) { n += 1; }
+			return n;
+#endif
+		}
+
+		inline size_t count(word_t const *w, size_t nwords)
+		{
+			size_t n = 0;
+			for (size_t i = 0; i < nwords; i++) {
+				n += popcount(w[i]);
+			}
+			return n;
+		}
+
+		// first set bit at or after position i, or npos
+		inline size_t find_from(word_t const *w, size_t nwords, size_t i)
+		{
+			size_t k = i / WORD_BITS;
+			if (k >= nwords) return npos;
+			word_t x = w[k] & mask_from(i);
+			while (!x) {
+				if (++k >= nwords) return npos;
+				x = w[k];
+			}
+			return k * WORD_BITS + ctz(x);
+		}
+
+		inline void set_range(word_t *w, size_t b, size_t e, bool v)
+		{
+			if (!(b < e)) return;
+			size_t kb = b / WORD_BITS;
+			size_t ke = (e - 1) / WORD_BITS;
+			word_t head = mask_from(b);
+			word_t tail = mask_below(e);
+			if (kb == ke) {
+				word_t m = head & tail;
+				w[kb] = v ? (w[kb] | m) : (w[kb] & ~m);
+				return;
+			}
+			w[kb] = v ? (w[kb] | head) : (w[kb] & ~head);
+			word_t fill = v ? ~(word_t)0 : 0;
+			for (size_t k = kb + 1; k < ke; k++) {
+				w[k] = fill;
+			}
+			w[ke] = v ? (w[ke] | tail) : (w[ke] & ~tail);
+		}
+
+		inline void and_words(word_t *d, word_t const *s, size_t nwords)
+		{
+			for (size_t i = 0; i < nwords; i++) d[i] &= s[i];
+		}
+
+		inline void or_words(word_t *d, word_t const *s, size_t nwords)
+		{
+			for (size_t i = 0; i < nwords; i++) d[i] |= s[i];
+		}
+
+		inline void xor_words(word_t *d, word_t const *s, size_t nwords)
+		{
+			for (size_t i = 0; i < nwords; i++) d[i] ^= s[i];
+		}
+
+		inline void not_words(word_t *d, size_t nwords)
+		{
+			for (size_t i = 0; i < nwords; i++) d[i] = ~d[i];
+		}
+
+		inline void fill_words(word_t *d, size_t nwords, bool v)
+		{
+			word_t fill = v ? ~(word_t)0 : 0;
+			for (size_t i = 0; i < nwords; i++) d[i] = fill;
+		}
+	}
+
+	template <size_t N> class bitset {
+	private:
+		enum {
+			NWORDS = (N + bits::WORD_BITS - 1) / bits::WORD_BITS
+		};
+		bits::word_t words[NWORDS > 0 ? NWORDS : 1];
+		void trim()
+		{
+			if (NWORDS > 0) words[NWORDS - 1] &= bits::mask_below(N);
+		}
+	public:
+		static const size_t npos = bits::npos;
+		bitset()
+		{
+			bits::fill_words(words, NWORDS, false);
+		}
+		size_t size() const
+		{
+			return N;
+		}
+		bool test(size_t i) const
+		{
+			return (words[i / bits::WORD_BITS] & bits::bit(i)) != 0;
+		}
+		bool operator [] (size_t i) const
+		{
+			return test(i);
+		}
+		void set(size_t i)
+		{
+			words[i / bits::WORD_BITS] |= bits::bit(i);
+		}
+		void set(size_t i, bool v)
+		{
+			if (v) set(i); else reset(i);
+		}
+		void reset(size_t i)
+		{
+			words[i / bits::WORD_BITS] &= ~bits::bit(i);
+		}
+		void flip(size_t i)
+		{
+			words[i / bits::WORD_BITS] ^= bits::bit(i);
+		}
+		void set()
+		{
+			bits::fill_words(words, NWORDS, true);
+			trim();
+		}
+		void reset()
+		{
+			bits::fill_words(words, NWORDS, false);
+		}
+		void flip()
+		{
+			bits::not_words(words, NWORDS);
+			trim();
+		}
+		// sets or clears the bits [b, e)
+		void set_range(size_t b, size_t e, bool v = true)
+		{
+			if (e > N) e = N;
+			bits::set_range(words, b, e, v);
+		}
+		void reset_range(size_t b, size_t e)
+		{
+			set_range(b, e, false);
+		}
+		size_t count() const
+		{
+			return bits::count(words, NWORDS);
+		}
+		bool any() const
+		{
+			return find_first() != npos;
+		}
+		bool none() const
+		{
+			return !any();
+		}
+		bool all() const
+		{
+			return count() == N;
+		}
+		size_t find_first() const
+		{
+			return bits::find_from(words, NWORDS, 0);
+		}
+		// first set bit after i, or npos
+		size_t find_next(size_t i) const
+		{
+			return bits::find_from(words, NWORDS, i + 1);
+		}
+		bits::word_t const *data() const
+		{
+			return words;
+		}
+		bitset &operator &= (bitset const &r)
+		{
+			bits::and_words(words, r.words, NWORDS);
+			return *this;
+		}
+		bitset &operator |= (bitset const &r)
+		{
+			bits::or_words(words, r.words, NWORDS);
+			return *this;
+		}
+		bitset &operator ^= (bitset const &r)
+		{
+			bits::xor_words(words, r.words, NWORDS);
+			return *this;
+		}
+		bitset operator & (bitset const &r) const
+		{
+			bitset t = *this;
+			return t &= r;
+		}
+		bitset operator | (bitset const &r) const
+		{
+			bitset t = *this;
+			return t |= r;
+		}
+		bitset operator ^ (bitset const &r) const
+		{
+			bitset t = *this;
+			return t ^= r;
+		}
+		bitset operator ~ () const
+		{
+			bitset t = *this;
+			t.flip();
+			return t;
+		}
+		bool operator == (bitset const &r) const
+		{
+			return memcmp(words, r.words, sizeof(words)) == 0;
+		}
+		bool operator != (bitset const &r) const
+		{
+			return !operator == (r);
+		}
+	};
+
+	// Dynamically sized bitset. Bulk operations between two bitvectors only
+	// touch the words both of them have.
+	class bitvector {
+	private:
+		vector<bits::word_t> words;
+		size_t nbits;
+		void trim()
+		{
+			if (!words.empty()) words[words.size() - 1] &= bits::mask_below(nbits);
+		}
+		static size_t min_words(bitvector const &a, bitvector const &b)
+		{
+			return a.words.size() < b.words.size() ? a.words.size() : b.words.size();
+		}
+	public:
+		static const size_t npos = bits::npos;
+		bitvector()
+			: nbits(0)
+		{
+		}
+		bitvector(size_t n, bool v = false)
+			: nbits(0)
+		{
+			resize(n, v);
+		}
+		size_t size() const
+		{
+			return nbits;
+		}
+		bool empty() const
+		{
+			return nbits == 0;
+		}
+		void reserve(size_t n)
+		{
+			words.reserve(bits::words_for(n));
+		}
+		void clear()
+		{
+			words.clear();
+			nbits = 0;
+		}
+		void resize(size_t n, bool v = false)
+		{
+			size_t nw = bits::words_for(n);
+			if (n > nbits) {
+				words.reserve(nw);
+				if (v && nbits % bits::WORD_BITS) {
+					words[words.size() - 1] |= bits::mask_from(nbits);
+				}
+				bits::word_t fill = v ? ~(bits::word_t)0 : 0;
+				while (words.size() < nw) {
+					words.push_back(fill);
+				}
+			} else {
+				while (words.size() > nw) {
+					words.pop_back();
+				}
+			}
+			nbits = n;
+			trim();
+		}
+		void push_back(bool v)
+		{
+			if (nbits % bits::WORD_BITS == 0) {
+				words.push_back(0);
+			}
+			if (v) {
+				words[nbits / bits::WORD_BITS] |= bits::bit(nbits);
+			}
+			nbits++;
+		}
+		void pop_back()
+		{
+			if (nbits > 0) {
+				resize(nbits - 1);
+			}
+		}
+		bool test(size_t i) const
+		{
+			return (words[i / bits::WORD_BITS] & bits::bit(i)) != 0;
+		}
+		bool operator [] (size_t i) const
+		{
+			return test(i);
+		}
+		void set(size_t i)
+		{
+			words[i / bits::WORD_BITS] |= bits::bit(i);
+		}
+		void set(size_t i, bool v)
+		{
+			if (v) set(i); else reset(i);
+		}
+		void reset(size_t i)
+		{
+			words[i / bits::WORD_BITS] &= ~bits::bit(i);
+		}
+		void flip(size_t i)
+		{
+			words[i / bits::WORD_BITS] ^= bits::bit(i);
+		}
+		void set()
+		{
+			if (!words.empty()) bits::fill_words(&words[0], words.size(), true);
+			trim();
+		}
+		void reset()
+		{
+			if (!words.empty()) bits::fill_words(&words[0], words.size(), false);
+		}
+		void flip()
+		{
+			if (!words.empty()) bits::not_words(&words[0], words.size());
+			trim();
+		}
+		// sets or clears the bits [b, e)
+		void set_range(size_t b, size_t e, bool v = true)
+		{
+			if (e > nbits) e = nbits;
+			if (b < e) bits::set_range(&words[0], b, e, v);
+		}
+		void reset_range(size_t b, size_t e)
+		{
+			set_range(b, e, false);
+		}
+		size_t count() const
+		{
+			return words.empty() ? 0 : bits::count(&words[0], words.size());
+		}
+		bool any() const
+		{
+			return find_first() != npos;
+		}
+		bool none() const
+		{
+			return !any();
+		}
+		bool all() const
+		{
+			return count() == nbits;
+		}
+		size_t find_first() const
+		{
+			return words.empty() ? npos : bits::find_from(&words[0], words.size(), 0);
+		}
+		// first set bit after i, or npos
+		size_t find_next(size_t i) const
+		{
+			return words.empty() ? npos : bits::find_from(&words[0], words.size(), i + 1);
+		}
+		bits::word_t const *data() const
+		{
+			return words.empty() ? 0 : &words[0];
+		}
+		bitvector &operator &= (bitvector const &r)
+		{
+			size_t n = min_words(*this, r);
+			if (n > 0) bits::and_words(&words[0], &r.words[0], n);
+			for (size_t i = n; i < words.size(); i++) {
+				words[i] = 0;
+			}
+			return *this;
+		}
+		bitvector &operator |= (bitvector const &r)
+		{
+			size_t n = min_words(*this, r);
+			if (n > 0) bits::or_words(&words[0], &r.words[0], n);
+			trim();
+			return *this;
+		}
+		bitvector &operator ^= (bitvector const &r)
+		{
+			size_t n = min_words(*this, r);
+			if (n > 0) bits::xor_words(&words[0], &r.words[0], n);
+			trim();
+			return *this;
+		}
+		bool operator == (bitvector const &r) const
+		{
+			if (nbits != r.nbits) return false;
+			return words.empty() || memcmp(&words[0], &r.words[0], sizeof(bits::word_t) * words.size()) == 0;
+		}
+		bool operator != (bitvector const &r) const
+		{
+			return !operator == (r);
+		}
+	};
+
+} // namespace tiny
+
+#endif
@@ -7,117 +7,497 @@
 
 #include <arduino.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <new>
 
+#if defined(__has_include)
+#if __has_include(<initializer_list>)
+#include <initializer_list>
+#define TINY_HAVE_INITIALIZER_LIST 1
+#endif
+#endif
+
+// Define TINY_CHECKED before including to trap out of range indexing,
+// dereferencing past the end and iterators left dangling by erase or a
+// reallocation. Without it the checks compile to nothing.
+#ifdef TINY_CHECKED
+#ifndef ARDUINO
+#include <stdio.h>
+#endif
+#define TINY_CHECK(cond, what) ((cond) ? (void)0 : tiny::detail::check_failed(what, __FILE__, __LINE__))
+#else
+#define TINY_CHECK(cond, what) ((void)0)
+#endif
+
 namespace tiny {
-	template <typename T> class vector {
+#ifdef TINY_ALLOC_STATS
+	// With TINY_ALLOC_STATS defined, every allocation made by the library
+	// is counted, so that tests can assert how many an operation makes.
+	// The counters are not atomic.
+	struct alloc_stats {
+		size_t allocations;
+		size_t frees;
+		size_t bytes; // total requested by the allocations
+		size_t failures;
+	};
+	inline alloc_stats &allocation_stats()
+	{
+		static alloc_stats stats = { 0, 0, 0, 0 };
+		return stats;
+	}
+	inline void reset_allocation_stats()
+	{
+		alloc_stats zero = { 0, 0, 0, 0 };
+		allocation_stats() = zero;
+	}
+#endif
+
+	namespace detail {
+		// All container memory goes through these two. Allocation failure is
+		// reported as a null pointer, never as an exception, so that the
+		// try_ functions can back out without touching the container.
+		inline void *allocate_bytes(size_t n)
+		{
+			void *p = new(std::nothrow) char [n];
+#ifdef TINY_ALLOC_STATS
+			if (p) {
+				allocation_stats().allocations++;
+				allocation_stats().bytes += n;
+			} else {
+				allocation_stats().failures++;
+			}
+#endif
+			return p;
+		}
+		inline void free_bytes(void *p)
+		{
+#ifdef TINY_ALLOC_STATS
+			if (p) {
+				allocation_stats().frees++;
+			}
+#endif
+			delete[] (char *)p;
+		}
+
+#ifdef TINY_CHECKED
+		typedef void (*check_handler_t)(char const *what, char const *file, int line);
+		inline check_handler_t &check_handler()
+		{
+			static check_handler_t h = 0;
+			return h;
+		}
+		inline void check_failed(char const *what, char const *file, int line)
+		{
+			if (check_handler()) {
+				check_handler()(what, file, line);
+				return;
+			}
+#ifndef ARDUINO
+			fprintf(stderr, "%s:%d: %s\n", file, line, what);
+#endif
+			abort();
+		}
+#endif
+	}
+
+#ifdef TINY_CHECKED
+	// called instead of abort() when a check fails; execution continues
+	// after it returns, so a handler that is not meant to stop the program
+	// should throw or longjmp
+	inline void set_check_handler(detail::check_handler_t h)
+	{
+		detail::check_handler() = h;
+	}
+#endif
+
+	template <typename T> struct is_trivially_copyable {
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1900)
+		static const bool value = __is_trivially_copyable(T);
+#else
+		static const bool value = __has_trivial_copy(T) && __has_trivial_destructor(T);
+#endif
+	};
+
+	// Size policies for vector and list. An unsigned integer type sets the
+	// type the container keeps its size and capacity in, which also bounds
+	// max_size(). heap_header<S> makes a vector keep them in front of the
+	// element array instead, so that an empty vector is a single pointer.
+	template <typename S> struct heap_header {
+	};
+
+	template <typename T, typename S> class vector_header {
+	private:
+		T *array;
+		S capacity_;
+		S count_;
+	public:
+		vector_header()
+			: array(0)
+			, capacity_(0)
+			, count_(0)
+		{
+		}
+		static size_t max_size()
+		{
+			return (S)-1;
+		}
+		T *data() const
+		{
+			return array;
+		}
+		size_t size() const
+		{
+			return count_;
+		}
+		size_t capacity() const
+		{
+			return capacity_;
+		}
+		void set_size(size_t n)
+		{
+			count_ = (S)n;
+		}
+		// null if out of memory
+		T *allocate(size_t n)
+		{
+			if (n > (size_t)-1 / sizeof(T)) {
+				return 0;
+			}
+			return (T *)detail::allocate_bytes(sizeof(T) * n);
+		}
+		// frees the current buffer and takes p, which was returned by allocate(n)
+		void replace(T *p, size_t n)
+		{
+			detail::free_bytes(array);
+			array = p;
+			capacity_ = (S)n;
+		}
+	};
+
+	template <typename T, typename S> class vector_header<T, heap_header<S> > {
 	private:
-		size_t capacity;
-		size_t count;
+		struct block_t {
+			S capacity;
+			S count;
+		};
+		enum {
+			offset = (sizeof(block_t) + alignof(T) - 1) / alignof(T) * alignof(T)
+		};
 		T *array;
+		block_t *block() const
+		{
+			return (block_t *)((char *)array - offset);
+		}
+	public:
+		vector_header()
+			: array(0)
+		{
+		}
+		static size_t max_size()
+		{
+			return (S)-1;
+		}
+		T *data() const
+		{
+			return array;
+		}
+		size_t size() const
+		{
+			return array ? block()->count : 0;
+		}
+		size_t capacity() const
+		{
+			return array ? block()->capacity : 0;
+		}
+		void set_size(size_t n)
+		{
+			if (array) {
+				block()->count = (S)n;
+			}
+		}
+		T *allocate(size_t n)
+		{
+			if (n > ((size_t)-1 - offset) / sizeof(T)) {
+				return 0;
+			}
+			char *p = (char *)detail::allocate_bytes(offset + sizeof(T) * n);
+			if (!p) {
+				return 0;
+			}
+			((block_t *)p)->capacity = (S)n;
+			((block_t *)p)->count = 0;
+			return (T *)(p + offset);
+		}
+		void replace(T *p, size_t)
+		{
+			size_t len = size();
+			if (array) {
+				detail::free_bytes((char *)array - offset);
+			}
+			array = p;
+			set_size(len);
+		}
+	};
+
+	template <typename T, typename S = size_t> class vector {
+	public:
+		class const_iterator;
+	private:
+		vector_header<T, S> header;
+		static void relocate(T *dst, T *src, size_t n)
+		{
+			// dst <= src, or the ranges don't overlap.
+			// the slots in front of src must already be destroyed
+			if (is_trivially_copyable<T>::value) {
+				if (n > 0) {
+					memmove((void *)dst, (void const *)src, sizeof(T) * n);
+				}
+			} else {
+				for (size_t i = 0; i < n; i++) {
+					new(dst + i) T(src[i]);
+					src[i].~T();
+				}
+			}
+		}
+		void compact_run(size_t *w, size_t r, size_t e)
+		{
+			if (r < e) {
+				if (*w < r) {
+					relocate(header.data() + *w, header.data() + r, e - r);
+				}
+				*w += e - r;
+			}
+		}
+		static void copy_construct(T *dst, T const *src, size_t n)
+		{
+			if (is_trivially_copyable<T>::value) {
+				if (n > 0) {
+					memcpy((void *)dst, (void const *)src, sizeof(T) * n);
+				}
+			} else {
+				for (size_t i = 0; i < n; i++) {
+					new(dst + i) T(src[i]);
+				}
+			}
+		}
+		static void fill_construct(T *dst, size_t n, T const &v)
+		{
+			if (is_trivially_copyable<T>::value && sizeof(T) == 1) {
+				memset((void *)dst, *(unsigned char const *)&v, n);
+			} else {
+				for (size_t i = 0; i < n; i++) {
+					new(dst + i) T(v);
+				}
+			}
+		}
+		template <typename I> I bind(I it) const
+		{
+#ifdef TINY_CHECKED
+			it.owner = this;
+#endif
+			return it;
+		}
+#ifdef TINY_CHECKED
+		// [p, p + n) must lie within the elements of owner, or if the
+		// iterator was not made by a vector, within lo and hi where given
+		static void check_iterator(vector const *owner, T const *p, size_t n, T const *lo, T const *hi)
+		{
+			if (owner) {
+				T const *b = owner->header.data();
+				TINY_CHECK(p >= b && (size_t)(p - b) <= owner->size() && n <= owner->size() - (p - b), "vector iterator out of range or invalidated");
+			} else {
+				TINY_CHECK(p && (!lo || p >= lo) && (!hi || (p <= hi && n <= (size_t)(hi - p))), "vector iterator out of range");
+			}
+		}
+#endif
+		// whether p points at one of the elements
+		bool contains(T const *p) const
+		{
+			T const *b = header.data();
+			return b && p >= b && p < b + header.size();
+		}
+		void swap_header(vector &r)
+		{
+			vector_header<T, S> h = header;
+			header = r.header;
+			r.header = h;
+		}
+		// destroys the contents and makes sure there is room for exactly n
+		// elements, without moving anything. on failure nothing is changed.
+		bool prepare(size_t n)
+		{
+			if (n > max_size()) {
+				return false;
+			}
+			if (header.capacity() < n) {
+				T *newarr = header.allocate(n);
+				if (!newarr) {
+					return false;
+				}
+				clear();
+				header.replace(newarr, n);
+			} else {
+				clear();
+			}
+			return true;
+		}
 	public:
 		vector()
-			: capacity(0)
-			, count(0)
-			, array(0)
 		{
 		}
 		vector(vector const &r)
-			: capacity(0)
-			, count(0)
-			, array(0)
 		{
-			reserve(r.size());
-			for (const_iterator it = r.begin(); it != r.end(); it++) {
-				push_back(*it);
-			}
+			assign(r.begin(), r.end());
 		}
+		vector(size_t n, T const &v)
+		{
+			assign(n, v);
+		}
+		vector(const_iterator first, const_iterator last)
+		{
+			assign(first, last);
+		}
+#ifdef TINY_HAVE_INITIALIZER_LIST
+		vector(std::initializer_list<T> list)
+		{
+			assign(list.begin(), list.end());
+		}
+#endif
 		~vector()
 		{
 			clear();
-			delete[] (char *)array;
+			header.replace(0, 0);
 		}
 		void operator = (vector const &r)
 		{
-			clear();
-			reserve(r.size());
-			for (const_iterator it = r.begin(); it != r.end(); it++) {
-				push_back(*it);
+			if (&r != this) {
+				assign(r.begin(), r.end());
 			}
 		}
-		class const_iterator;
+		void assign(const_iterator first, const_iterator last)
+		{
+			size_t n = first < last ? last - first : 0;
+			if (n > 0 && contains(first.ptr)) {
+				// prepare() would destroy the source; build aside and swap
+				vector tmp(first, last);
+				if (tmp.size() == n) {
+					swap_header(tmp);
+				}
+				return;
+			}
+			if (prepare(n) && n > 0) {
+				copy_construct(header.data(), first.ptr, n);
+				header.set_size(n);
+			}
+		}
+		void assign(size_t n, T const &v)
+		{
+			if (contains(&v)) {
+				T copy(v);
+				assign(n, copy);
+				return;
+			}
+			if (prepare(n) && n > 0) {
+				fill_construct(header.data(), n, v);
+				header.set_size(n);
+			}
+		}
+		// Iterators are plain pointers in release builds. With TINY_CHECKED
+		// an iterator obtained from the vector also remembers it, so that
+		// using one after the elements it points to were erased or moved
+		// by a reallocation is caught.
 		class iterator {
 			friend vector;
 			friend const_iterator;
 		private:
 			T *ptr;
 			T *end;
-			int compare(iterator const &r) const
-			{
-				return ptr - r.ptr;
-			}
-			bool isnull() const
+#ifdef TINY_CHECKED
+			vector const *owner;
+#endif
+			void check(T const *p, size_t n) const
 			{
-				return !ptr || ptr == end;
+#ifdef TINY_CHECKED
+				check_iterator(owner, p, n, 0, end);
+#else
+				(void)p;
+				(void)n;
+#endif
 			}
 		public:
 			iterator(T *p, T *end = 0)
 				: ptr(p)
 				, end(end)
+#ifdef TINY_CHECKED
+				, owner(0)
+#endif
 			{
 			}
-			bool operator == (iterator it) const
+			bool operator == (iterator const &it) const
 			{
-				if (isnull() && it.isnull()) return true;
-				return compare(it) == 0;
+				return ptr == it.ptr;
 			}
-			bool operator != (iterator it) const
+			bool operator != (iterator const &it) const
 			{
-				return !operator == (it);
+				return ptr != it.ptr;
 			}
 			void operator ++ ()
 			{
-				if (!isnull()) ptr++;
+				check(ptr, 1);
+				ptr++;
 			}
 			void operator ++ (int)
 			{
-				if (!isnull()) ptr++;
+				check(ptr, 1);
+				ptr++;
 			}
-			T &operator * ()
+			T &operator * () const
 			{
+				check(ptr, 1);
 				return *ptr;
 			}
-			T *operator -> ()
+			T *operator -> () const
+			{
+				check(ptr, 1);
+				return ptr;
+			}
+			T *get() const
 			{
 				return ptr;
 			}
 			iterator operator + (size_t n) const
 			{
-				return isnull() ? iterator(end, end) : iterator(ptr + n, end);
+				check(ptr, n);
+				iterator it(*this);
+				it.ptr += n;
+				return it;
 			}
 			iterator operator - (size_t n) const
 			{
-				return isnull() ? iterator(end, end) : iterator(ptr - n, end);
+				check(ptr - n, n);
+				iterator it(*this);
+				it.ptr -= n;
+				return it;
 			}
 			bool operator < (iterator const &it) const
 			{
-				return compare(it) < 0;
+				return ptr < it.ptr;
 			}
 			bool operator > (iterator const &it) const
 			{
-				return compare(it) > 0;
+				return ptr > it.ptr;
 			}
 			bool operator <= (iterator const &it) const
 			{
-				return compare(it) <= 0;
+				return ptr <= it.ptr;
 			}
 			bool operator >= (iterator const &it) const
 			{
-				return compare(it) >= 0;
+				return ptr >= it.ptr;
 			}
 			size_t operator - (iterator const &it) const
 			{
-				if (!ptr || !it.ptr) return 0;
 				return ptr - it.ptr;
 			}
 		};
@@ -126,152 +506,191 @@ namespace tiny {
 		private:
 			T const *ptr;
 			T const *end;
-			int compare(const_iterator const &r) const
-			{
-				return ptr - r.ptr;
-			}
-			bool isnull() const
+#ifdef TINY_CHECKED
+			vector const *owner;
+#endif
+			void check(T const *p, size_t n) const
 			{
-				return !ptr || ptr == end;
+#ifdef TINY_CHECKED
+				check_iterator(owner, p, n, 0, end);
+#else
+				(void)p;
+				(void)n;
+#endif
 			}
 		public:
 			const_iterator(T const *p, T const *end = 0)
 				: ptr(p)
 				, end(end)
+#ifdef TINY_CHECKED
+				, owner(0)
+#endif
 			{
 			}
 			const_iterator(iterator const &it)
 				: ptr(it.ptr)
 				, end(it.end)
+#ifdef TINY_CHECKED
+				, owner(it.owner)
+#endif
 			{
 			}
-			bool operator == (const_iterator it) const
+			bool operator == (const_iterator const &it) const
 			{
-				if (isnull() && it.isnull()) return true;
-				return compare(it) == 0;
+				return ptr == it.ptr;
 			}
-			bool operator != (const_iterator it) const
+			bool operator != (const_iterator const &it) const
 			{
-				return !operator == (it);
+				return ptr != it.ptr;
 			}
 			void operator ++ ()
 			{
-				if (!isnull()) ptr++;
+				check(ptr, 1);
+				ptr++;
 			}
 			void operator ++ (int)
 			{
-				if (!isnull()) ptr++;
+				check(ptr, 1);
+				ptr++;
 			}
 			T const &operator * () const
 			{
+				check(ptr, 1);
 				return *ptr;
 			}
 			T const *operator -> () const
 			{
+				check(ptr, 1);
 				return ptr;
 			}
-			iterator operator + (size_t n) const
+			T const *get() const
+			{
+				return ptr;
+			}
+			const_iterator operator + (size_t n) const
 			{
-				return isnull() ? const_iterator(end, end) : const_iterator(ptr + n, end);
+				check(ptr, n);
+				const_iterator it(*this);
+				it.ptr += n;
+				return it;
 			}
-			iterator operator - (size_t n) const
+			const_iterator operator - (size_t n) const
 			{
-				return isnull() ? const_iterator(end, end) : const_iterator(ptr - n, end);
+				check(ptr - n, n);
+				const_iterator it(*this);
+				it.ptr -= n;
+				return it;
 			}
 			bool operator < (const_iterator const &it) const
 			{
-				return compare(it) < 0;
+				return ptr < it.ptr;
 			}
 			bool operator > (const_iterator const &it) const
 			{
-				return compare(it) > 0;
+				return ptr > it.ptr;
 			}
 			bool operator <= (const_iterator const &it) const
 			{
-				return compare(it) <= 0;
+				return ptr <= it.ptr;
 			}
 			bool operator >= (const_iterator const &it) const
 			{
-				return compare(it) >= 0;
+				return ptr >= it.ptr;
 			}
 			size_t operator - (const_iterator const &it) const
 			{
-				if (!ptr || !it.ptr) return 0;
 				return ptr - it.ptr;
 			}
 		};
+		// ptr points one past the element it refers to; end is the start
+		// of the array
 		class reverse_iterator {
 			friend vector;
 			friend const_iterator;
 		private:
 			T *ptr;
 			T *end;
-			int compare(reverse_iterator const &r) const
-			{
-				return ptr - r.ptr;
-			}
-			bool isnull() const
+#ifdef TINY_CHECKED
+			vector const *owner;
+#endif
+			void check(T const *p, size_t n) const
 			{
-				return !ptr || ptr == end;
+#ifdef TINY_CHECKED
+				check_iterator(owner, p, n, end, 0);
+#else
+				(void)p;
+				(void)n;
+#endif
 			}
 		public:
 			reverse_iterator(T *p, T *end = 0)
 				: ptr(p)
 				, end(end)
+#ifdef TINY_CHECKED
+				, owner(0)
+#endif
 			{
 			}
-			bool operator == (reverse_iterator it) const
+			bool operator == (reverse_iterator const &it) const
 			{
-				if (isnull() && it.isnull()) return true;
-				return compare(it) == 0;
+				return ptr == it.ptr;
 			}
-			bool operator != (reverse_iterator it) const
+			bool operator != (reverse_iterator const &it) const
 			{
-				return !operator == (it);
+				return ptr != it.ptr;
 			}
 			void operator ++ ()
 			{
-				if (!isnull()) ptr--;
+				check(ptr - 1, 1);
+				ptr--;
 			}
 			void operator ++ (int)
 			{
-				if (!isnull()) ptr--;
+				check(ptr - 1, 1);
+				ptr--;
 			}
-			T &operator * ()
+			T &operator * () const
 			{
+				check(ptr - 1, 1);
 				return ptr[-1];
 			}
-			T *operator -> ()
+			T *operator -> () const
 			{
+				check(ptr - 1, 1);
 				return &ptr[-1];
 			}
 			reverse_iterator operator + (size_t n) const
 			{
-				return isnull() ? reverse_iterator(end, end) : reverse_iterator(ptr - n, end);
+				check(ptr - n, n);
+				reverse_iterator it(*this);
+				it.ptr -= n;
+				return it;
 			}
 			reverse_iterator operator - (size_t n) const
 			{
-				return isnull() ? reverse_iterator(end, end) : reverse_iterator(ptr + n, end);
+				check(ptr, n);
+				reverse_iterator it(*this);
+				it.ptr += n;
+				return it;
 			}
 			bool operator < (reverse_iterator const &it) const
 			{
-				return compare(it) > 0;
+				return ptr > it.ptr;
 			}
 			bool operator > (reverse_iterator const &it) const
 			{
-				return compare(it) < 0;
+				return ptr < it.ptr;
 			}
 			bool operator <= (reverse_iterator const &it) const
 			{
-				return compare(it) >= 0;
+				return ptr >= it.ptr;
 			}
 			bool operator >= (reverse_iterator const &it) const
 			{
-				return compare(it) <= 0;
+				return ptr <= it.ptr;
 			}
 			size_t operator - (reverse_iterator const &it) const
 			{
-				if (!ptr || !it.ptr) return 0;
 				return it.ptr - ptr;
 			}
 		};
@@ -281,208 +700,267 @@ namespace tiny {
 		private:
 			T const *ptr;
 			T const *end;
-			int compare(const_reverse_iterator const &r) const
-			{
-				return ptr - r.ptr;
-			}
-			bool isnull() const
+#ifdef TINY_CHECKED
+			vector const *owner;
+#endif
+			void check(T const *p, size_t n) const
 			{
-				return !ptr || ptr == end;
+#ifdef TINY_CHECKED
+				check_iterator(owner, p, n, end, 0);
+#else
+				(void)p;
+				(void)n;
+#endif
 			}
 		public:
 			const_reverse_iterator(T *p, T *end = 0)
 				: ptr(p)
 				, end(end)
+#ifdef TINY_CHECKED
+				, owner(0)
+#endif
 			{
 			}
 			const_reverse_iterator(reverse_iterator const &r)
 				: ptr(r.ptr)
 				, end(r.end)
+#ifdef TINY_CHECKED
+				, owner(r.owner)
+#endif
 			{
 			}
-			bool operator == (const_reverse_iterator it) const
+			bool operator == (const_reverse_iterator const &it) const
 			{
-				if (isnull() && it.isnull()) return true;
-				return compare(it) == 0;
+				return ptr == it.ptr;
 			}
-			bool operator != (const_reverse_iterator it) const
+			bool operator != (const_reverse_iterator const &it) const
 			{
-				return !operator == (it);
+				return ptr != it.ptr;
 			}
 			void operator ++ ()
 			{
-				if (!isnull()) ptr--;
+				check(ptr - 1, 1);
+				ptr--;
 			}
 			void operator ++ (int)
 			{
-				if (!isnull()) ptr--;
+				check(ptr - 1, 1);
+				ptr--;
 			}
 			T const &operator * () const
 			{
+				check(ptr - 1, 1);
 				return ptr[-1];
 			}
 			T const *operator -> () const
 			{
+				check(ptr - 1, 1);
 				return &ptr[-1];
 			}
 			const_reverse_iterator operator + (size_t n) const
 			{
-				return isnull() ? const_reverse_iterator(end, end) : const_reverse_iterator(ptr - n, end);
+				check(ptr - n, n);
+				const_reverse_iterator it(*this);
+				it.ptr -= n;
+				return it;
 			}
 			const_reverse_iterator operator - (size_t n) const
 			{
-				return isnull() ? const_reverse_iterator(end, end) : const_reverse_iterator(ptr + n, end);
+				check(ptr, n);
+				const_reverse_iterator it(*this);
+				it.ptr += n;
+				return it;
 			}
 			bool operator < (const_reverse_iterator const &it) const
 			{
-				return compare(it) > 0;
+				return ptr > it.ptr;
 			}
 			bool operator > (const_reverse_iterator const &it) const
 			{
-				return compare(it) < 0;
+				return ptr < it.ptr;
 			}
 			bool operator <= (const_reverse_iterator const &it) const
 			{
-				return compare(it) >= 0;
+				return ptr >= it.ptr;
 			}
 			bool operator >= (const_reverse_iterator const &it) const
 			{
-				return compare(it) <= 0;
+				return ptr <= it.ptr;
 			}
 			size_t operator - (const_reverse_iterator const &it) const
 			{
-				if (!ptr || !it.ptr) return 0;
 				return it.ptr - ptr;
 			}
 		};
 		size_t size() const
 		{
-			return count;
+			return header.size();
 		}
-		void resize(size_t n)
+		size_t capacity() const
 		{
-			while (size() < n) push_back(T());
-			while (size() > n) pop_back();
+			return header.capacity();
+		}
+		static size_t max_size()
+		{
+			return vector_header<T, S>::max_size();
+		}
+		void resize(size_t n, T const &v = T())
+		{
+			size_t count = size();
+			if (n > count) {
+				if (n > header.capacity()) {
+					if (contains(&v)) {
+						// growing moves the elements
+						T copy(v);
+						resize(n, copy);
+						return;
+					}
+					// grow geometrically, so that resizing one element at a
+					// time stays amortized O(1)
+					size_t cap = header.capacity() * 2;
+					if (cap > max_size()) {
+						cap = max_size();
+					}
+					if (!try_reserve(cap > n ? cap : n)) {
+						return;
+					}
+				}
+				fill_construct(header.data() + count, n - count, v);
+				header.set_size(n);
+			} else {
+				T *array = header.data();
+				for (size_t i = n; i < count; i++) {
+					array[i].~T();
+				}
+				header.set_size(n);
+			}
 		}
 		bool empty() const
 		{
 			return size() == 0;
 		}
-		void reserve(size_t n)
+		// returns false, leaving the vector as it was, if n exceeds
+		// max_size() or memory runs out
+		bool try_reserve(size_t n)
 		{
-			if (capacity < n) {
-				T *newarr = (T *)new char [sizeof(T) * n];
-				for (size_t i = 0; i < count; i++) {
-					new(newarr + i) T(array[i]);
-					array[i].~T();
+			if (header.capacity() < n) {
+				if (n > max_size()) {
+					return false;
 				}
-				delete[] (char *)array;
-				array = newarr;
-				capacity = n;
+				T *array = header.data();
+				T *newarr = header.allocate(n);
+				if (!newarr) {
+					return false;
+				}
+				relocate(newarr, array, header.size());
+				header.replace(newarr, n);
 			}
+			return true;
+		}
+		void reserve(size_t n)
+		{
+			try_reserve(n);
+		}
+		// gives back unused capacity. false if the smaller buffer could
+		// not be allocated, in which case the vector is unchanged.
+		bool shrink_to_fit()
+		{
+			size_t count = header.size();
+			if (header.capacity() == count) {
+				return true;
+			}
+			if (count == 0) {
+				header.replace(0, 0);
+				return true;
+			}
+			T *newarr = header.allocate(count);
+			if (!newarr) {
+				return false;
+			}
+			relocate(newarr, header.data(), count);
+			header.replace(newarr, count);
+			return true;
 		}
 		void clear()
 		{
+			T *array = header.data();
+			size_t count = header.size();
 			for (size_t i = 0; i < count; i++) {
 				array[i].~T();
 			}
-			count = 0;
+			header.set_size(0);
 		}
 		iterator begin()
 		{
-			if (array) {
-				return iterator(array, array + count);
-			} else {
-				return iterator(0, 0);
-			}
+			T *array = header.data();
+			return bind(iterator(array, array + size()));
 		}
 		const_iterator begin() const
 		{
-			if (array) {
-				return const_iterator(array, array + count);
-			} else {
-				return const_iterator(0, 0);
-			}
+			T const *array = header.data();
+			return bind(const_iterator(array, array + size()));
 		}
 		reverse_iterator rbegin()
 		{
-			if (array) {
-				return reverse_iterator(array + count, array);
-			} else {
-				return reverse_iterator(0, 0);
-			}
+			T *array = header.data();
+			return bind(reverse_iterator(array + size(), array));
 		}
 		const_reverse_iterator rbegin() const
 		{
-			if (array) {
-				return const_reverse_iterator(array + count, array);
-			} else {
-				return const_reverse_iterator(0, 0);
-			}
+			T *array = header.data();
+			return bind(const_reverse_iterator(array + size(), array));
 		}
 		iterator end()
 		{
-			if (array) {
-				return iterator(array + count, array + count);
-			} else {
-				return iterator(0, 0);
-			}
+			T *array = header.data();
+			return bind(iterator(array + size(), array + size()));
 		}
 		const_iterator end() const
 		{
-			if (array) {
-				return const_iterator(array + count, array + count);
-			} else {
-				return const_iterator(0, 0);
-			}
+			T const *array = header.data();
+			return bind(const_iterator(array + size(), array + size()));
 		}
 		reverse_iterator rend()
 		{
-			if (array) {
-				return reverse_iterator(array, array);
-			} else {
-				return reverse_iterator(0, 0);
-			}
+			T *array = header.data();
+			return bind(reverse_iterator(array, array));
 		}
 		const_reverse_iterator rend() const
 		{
-			if (array) {
-				return const_reverse_iterator(array, array);
-			} else {
-				return const_reverse_iterator(0, 0);
-			}
+			T *array = header.data();
+			return bind(const_reverse_iterator(array, array));
 		}
 		iterator insert(iterator it, const_iterator b, const_iterator e)
 		{
 			if (b < e) {
+				T *array = header.data();
+				size_t count = header.size();
 				size_t i;
 				if (it == end()) {
 					i = count;
 				} else {
 					i = it.ptr - array;
 				}
-				size_t next = 0;
 				size_t n = e - b;
-				if (n > capacity - count) {
-					vector newvec;
-					newvec.capacity = ((count + n + 7) & ~7) * 2;
-					newvec.array = (T *)new char [sizeof(T) * newvec.capacity];
-					if (array && i > 0) {
-						newvec.insert(newvec.end(), begin(), begin() + i);
+				if (n > header.capacity() - count) {
+					if (n > max_size() - count) {
+						return iterator(0, 0);
 					}
-					newvec.insert(newvec.end(), b, e);
-					next = newvec.size();
-					if (array && count - i > 0) {
-						newvec.insert(newvec.end(), begin() + i, end());
+					size_t cap = ((count + n + 7) & ~7) * 2;
+					if (cap > max_size()) {
+						cap = max_size();
 					}
-					clear();
-					delete array;
-					capacity = newvec.capacity;
-					array = newvec.array;
-					count = newvec.count;
-					newvec.capacity = 0;
-					newvec.count = 0;
-					newvec.array = 0;
+					T *newarr = header.allocate(cap);
+					if (!newarr) {
+						return iterator(0, 0);
+					}
+					for (size_t j = 0; j < n; j++) {
+						new(newarr + i + j) T(b.ptr[j]);
+					}
+					relocate(newarr, array, i);
+					relocate(newarr + i + n, array + i, count - i);
+					header.replace(newarr, cap);
+					array = newarr;
 				} else {
 					size_t mv = count - i;
 					for (size_t j = 0; j < mv; j++) {
@@ -492,10 +970,10 @@ namespace tiny {
 					for (size_t j = 0; j < n; j++) {
 						new(array + i + j) T(b.ptr[j]);
 					}
-					count += n;
-					next = i + n;
 				}
-				return iterator(array + next, array + count);
+				count += n;
+				header.set_size(count);
+				return bind(iterator(array + i + n, array + count));
 			}
 			return iterator(0, 0);
 		}
@@ -506,57 +984,158 @@ namespace tiny {
 		}
 		void push_back(T const &t)
 		{
+			try_push_back(t);
+		}
+		// false if the vector is full or out of memory
+		bool try_push_back(T const &t)
+		{
+			size_t count = header.size();
+			if (count < header.capacity()) {
+				new(header.data() + count) T(t);
+				header.set_size(count + 1);
+				return true;
+			}
 			T const *p = &t;
-			insert(end(), p, p + 1);
+			return insert(end(), p, p + 1).get() != 0;
 		}
 		void pop_back()
 		{
+			size_t count = header.size();
 			if (count > 0) {
 				count--;
-				array[count].~T();
+				header.data()[count].~T();
+				header.set_size(count);
+			}
+		}
+		iterator erase(iterator b, iterator e)
+		{
+			T *array = header.data();
+			if (!array) {
+				return end();
+			}
+			size_t count = header.size();
+			size_t i = b.ptr - array;
+			size_t j = e.ptr - array;
+			if (j > count) {
+				j = count;
+			}
+			if (i < j) {
+				for (size_t k = i; k < j; k++) {
+					array[k].~T();
+				}
+				relocate(array + i, array + j, count - j);
+				count -= j - i;
+				header.set_size(count);
+			}
+			return bind(iterator(array + i, array + count));
+		}
+		iterator erase(iterator it)
+		{
+			return erase(it, it + 1);
+		}
+		template <typename Pred> size_t erase_if(Pred pred)
+		{
+			T *array = header.data();
+			size_t count = header.size();
+			size_t w = 0;
+			size_t r = 0;
+			for (size_t i = 0; i < count; i++) {
+				if (pred(array[i])) {
+					compact_run(&w, r, i);
+					array[i].~T();
+					r = i + 1;
+				}
 			}
+			compact_run(&w, r, count);
+			header.set_size(w);
+			return count - w;
+		}
+		size_t remove_duplicates()
+		{
+			// removes consecutive equal elements, like std::unique
+			T *array = header.data();
+			size_t count = header.size();
+			size_t w = 0;
+			size_t r = 0;
+			for (size_t i = 1; i < count; i++) {
+				T const &prev = r < i ? array[i - 1] : array[w - 1];
+				if (array[i] == prev) {
+					compact_run(&w, r, i);
+					array[i].~T();
+					r = i + 1;
+				}
+			}
+			compact_run(&w, r, count);
+			header.set_size(w);
+			return count - w;
 		}
 		T &operator [] (size_t i)
 		{
-			return array[i];
+			TINY_CHECK(i < size(), "vector index out of range");
+			return header.data()[i];
 		}
 		T const &operator [] (size_t i) const
 		{
-			return array[i];
+			TINY_CHECK(i < size(), "vector index out of range");
+			return header.data()[i];
 		}
 	};
 
-	template <typename T> class list {
+	template <typename T, typename S = size_t> class list {
 	private:
 		struct node_t {
 			node_t *next;
 			node_t *prev;
 			T val;
 			node_t(T const &v)
-				: val(v)
-				, next(0)
+				: next(0)
 				, prev(0)
+				, val(v)
 			{
 			}
 		};
 		node_t *first;
 		node_t *last;
-		size_t count;
+		S count;
+		static void free_node(node_t *node)
+		{
+			node->~node_t();
+			detail::free_bytes(node);
+		}
+		static node_t *new_node(T const &v)
+		{
+			void *p = detail::allocate_bytes(sizeof(node_t));
+			return p ? new(p) node_t(v) : 0;
+		}
+		// appends [b, e), stopping if memory runs out
+		template <typename It> void construct(It b, It e)
+		{
+			for (It it = b; it != e; it++) {
+				if (!try_push_back(*it)) {
+					break;
+				}
+			}
+		}
 	public:
 		list()
-			: count(0)
-			, first(0)
+			: first(0)
 			, last(0)
+			, count(0)
 		{
 		}
 		list(list const &r)
-			: count(0)
-			, first(0)
+			: first(0)
 			, last(0)
+			, count(0)
 		{
-			for (const_iterator it = r.begin(); it != r.end(); it++) {
-				push_back(*it);
-			}
+			construct(r.begin(), r.end());
+		}
+		template <typename It> list(It b, It e)
+			: first(0)
+			, last(0)
+			, count(0)
+		{
+			construct(b, e);
 		}
 		~list()
 		{
@@ -564,9 +1143,9 @@ namespace tiny {
 		}
 		void operator = (list const &r)
 		{
-			clear();
-			for (const_iterator it = r.begin(); it != r.end(); it++) {
-				push_back(*it);
+			if (&r != this) {
+				clear();
+				construct(r.begin(), r.end());
 			}
 		}
 		size_t size() const
@@ -604,38 +1183,44 @@ namespace tiny {
 			}
 			void operator ++ ()
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			void operator ++ (int)
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			void operator -- ()
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			void operator -- (int)
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			iterator operator + (size_t n) const
 			{
 				iterator it(node);
-				while (it.node && n > 0) it++;
+				for (; n > 0; n--) it++;
 				return it;
 			}
 			iterator operator - (size_t n) const
 			{
 				iterator it(node);
-				while (it.node && n > 0) it--;
+				for (; n > 0; n--) it--;
 				return it;
 			}
 			T &operator * ()
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return node->val;
 			}
 			T *operator -> ()
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return &node->val;
 			}
 		};
@@ -662,38 +1247,44 @@ namespace tiny {
 			}
 			void operator ++ ()
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			void operator ++ (int)
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			void operator -- ()
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			void operator -- (int)
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			const_iterator operator + (size_t n) const
 			{
 				const_iterator it(node);
-				while (it.node && n > 0) it++;
+				for (; n > 0; n--) it++;
 				return it;
 			}
 			const_iterator operator - (size_t n) const
 			{
 				const_iterator it(node);
-				while (it.node && n > 0) it--;
+				for (; n > 0; n--) it--;
 				return it;
 			}
 			T const &operator * () const
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return node->val;
 			}
 			T const *operator -> () const
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return &node->val;
 			}
 		};
@@ -717,38 +1308,44 @@ namespace tiny {
 			}
 			void operator ++ ()
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			void operator ++ (int)
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			void operator -- ()
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			void operator -- (int)
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			reverse_iterator operator + (size_t n) const
 			{
 				reverse_iterator it(node);
-				while (it.node && n > 0) it++;
+				for (; n > 0; n--) it++;
 				return it;
 			}
 			reverse_iterator operator - (size_t n) const
 			{
 				reverse_iterator it(node);
-				while (it.node && n > 0) it--;
+				for (; n > 0; n--) it--;
 				return it;
 			}
 			T &operator * ()
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return node->val;
 			}
 			T *operator -> ()
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return &node->val;
 			}
 		};
@@ -776,38 +1373,44 @@ namespace tiny {
 			}
 			void operator ++ ()
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			void operator ++ (int)
 			{
-				if (node) node = node->prev;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->prev;
 			}
 			void operator -- ()
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			void operator -- (int)
 			{
-				if (node) node = node->next;
+				TINY_CHECK(node, "list iterator moved past the end");
+				node = node->next;
 			}
 			const_reverse_iterator operator + (size_t n) const
 			{
 				const_reverse_iterator it(node);
-				while (it.node && n > 0) it++;
+				for (; n > 0; n--) it++;
 				return it;
 			}
 			const_reverse_iterator operator - (size_t n) const
 			{
 				const_reverse_iterator it(node);
-				while (it.node && n > 0) it--;
+				for (; n > 0; n--) it--;
 				return it;
 			}
 			T const &operator * () const
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return node->val;
 			}
 			T const *operator -> () const
 			{
+				TINY_CHECK(node, "list iterator dereferenced at the end");
 				return &node->val;
 			}
 		};
@@ -837,13 +1440,14 @@ namespace tiny {
 		}
 		void erase(iterator it)
 		{
+			TINY_CHECK(!first || it.node, "list erase at the end");
 			if (first) {
 				if (it.node == first) {
 					first = it.node->next;
-					if (first && first->next) first->next->prev = 0;
+					if (first) first->prev = 0;
 				} else if (it.node == last) {
 					last = it.node->prev;
-					if (last && last->prev) last->prev->next = 0;
+					if (last) last->next = 0;
 				} else {
 					if (it.node->prev) it.node->prev->next =it.node->next;
 					if (it.node->next) it.node->next->prev =it.node->prev;
@@ -852,13 +1456,23 @@ namespace tiny {
 					first = last = 0;
 				}
 				count--;
-				delete it.node;
+				free_node(it.node);
 			}
 		}
+		static size_t max_size()
+		{
+			return (S)-1;
+		}
 		iterator insert(iterator it, T const &v)
 		{
+			if (count == max_size()) {
+				return end();
+			}
 			if (first) {
-				node_t *node = new node_t(v);
+				node_t *node = new_node(v);
+				if (!node) {
+					return end();
+				}
 				if (it.node) {
 					if (it.node == first) {
 						node->next = first;
@@ -883,7 +1497,11 @@ namespace tiny {
 				count++;
 				return iterator(node);
 			} else {
-				first = last = new node_t(v);
+				node_t *node = new_node(v);
+				if (!node) {
+					return end();
+				}
+				first = last = node;
 				count = 1;
 				return iterator(first);
 			}
@@ -892,31 +1510,114 @@ namespace tiny {
 		{
 			insert(end(), v);
 		}
+		// false if the list is full or out of memory
+		bool try_push_back(T const &v)
+		{
+			return insert(end(), v) != end();
+		}
 	};
 
-	template <typename T> T const *zerostring();
+	// generic versions serve char16_t, char32_t and wchar_t
+	template <typename T> T const *zerostring()
+	{
+		static const T z = T();
+		return &z;
+	}
 	template <> inline char const *zerostring<char>() { return ""; }
 
-	template <typename T> size_t strlength(T const *p);
-	template <> size_t strlength(char const *p) { return strlen(p); }
+	template <typename T> size_t strlength(T const *p)
+	{
+		T const *e = p;
+		while (*e) e++;
+		return e - p;
+	}
+	template <> inline size_t strlength(char const *p) { return strlen(p); }
+
+	template <typename T> int t_strcmp(T const *a, T const *b)
+	{
+		while (*a && *a == *b) {
+			a++;
+			b++;
+		}
+		return *a < *b ? -1 : (*b < *a ? 1 : 0);
+	}
+	template <> inline int t_strcmp(char const *a, char const *b) { return strcmp(a, b); }
 
-	template <typename T> class t_stringbuffer {
-	private:
-		struct fragment_t {
-			fragment_t *next;
+	// How a t_stringbuffer keeps its text.
+	//   STRING_FRAGMENTS: appends add fragments to a chain, never copying
+	//     what is already there; c_str() joins them. For strings that are
+	//     built once and read once.
+	//   STRING_CONTIGUOUS: one buffer that grows geometrically, so that
+	//     c_str() is O(1) and never allocates.
+	//   STRING_AUTO: fragments, until c_str() first has to join them; from
+	//     then on contiguous. The default.
+	enum string_layout {
+		STRING_AUTO,
+		STRING_CONTIGUOUS,
+		STRING_FRAGMENTS,
+	};
+
+	namespace detail {
+		template <typename T> struct string_fragment {
+			string_fragment *next;
 			size_t size;
 			size_t used;
 			T data[1];
 		};
-		struct core_t {
+		template <typename T> struct string_core {
+			enum {
+				STATIC_REF = ~0u // the core of a literal; never counted or freed
+			};
 			unsigned int ref;
-			mutable fragment_t *fragment;
-			core_t()
-				: ref(0)
+			mutable string_fragment<T> *fragment;
+			mutable unsigned char layout; // string_layout
+			constexpr string_core(unsigned int ref = 0)
+				: ref(ref)
 				, fragment(0)
+				, layout(STRING_AUTO)
 			{
 			}
 		};
+	}
+
+	// A string constant that a t_stringbuffer can share without copying.
+	// The length is taken from the array at compile time. Strings made
+	// from a literal point at it until they are first modified, so the
+	// literal must outlive them: declare it static or constexpr.
+	//
+	//   static constexpr tiny::literal label("Temperature");
+	//   tiny::string s = label; // no allocation
+	template <typename T> class basic_literal : public detail::string_core<T> {
+	private:
+		T const *ptr;
+		size_t len;
+	public:
+		template <size_t N> constexpr basic_literal(T const (&s)[N])
+			: detail::string_core<T>(detail::string_core<T>::STATIC_REF)
+			, ptr(s)
+			, len(N - 1)
+		{
+		}
+		constexpr T const *c_str() const
+		{
+			return ptr;
+		}
+		constexpr size_t size() const
+		{
+			return len;
+		}
+	};
+
+	typedef basic_literal<char> literal;
+
+	template <typename T> class t_stringbuffer {
+	private:
+		typedef detail::string_fragment<T> fragment_t;
+		typedef detail::string_core<T> core_t;
+		enum {
+			MIN_FRAGMENT = 32,
+			MAX_FRAGMENT = 4096,
+		};
 		struct data_ {
 			core_t *core;
 			data_()
@@ -924,17 +1625,35 @@ namespace tiny {
 			{
 			}
 		} data;
-		void assign(core_t *p)
+		static basic_literal<T> const *literal_of(core_t const *p)
+		{
+			return p->ref == core_t::STATIC_REF ? static_cast<basic_literal<T> const *>(p) : 0;
+		}
+		// a new empty core, or if there is no memory for one, the core of an
+		// empty literal, which reads as an empty string and is copied on the
+		// first write like any other literal
+		static core_t *new_core()
 		{
+			void *p = detail::allocate_bytes(sizeof(core_t));
 			if (p) {
+				return new(p) core_t();
+			}
+			static const T z[1] = { T() };
+			static const basic_literal<T> empty(z);
+			return const_cast<basic_literal<T> *>(&empty);
+		}
+		void assign(core_t *p)
+		{
+			if (p && p->ref != core_t::STATIC_REF) {
 				p->ref++;
 			}
-			if (data.core) {
+			if (data.core && data.core->ref != core_t::STATIC_REF) {
 				if (data.core->ref > 1) {
 					data.core->ref--;
 				} else {
 					internal_clear();
-					delete data.core;
+					data.core->~core_t();
+					detail::free_bytes(data.core);
 				}
 			}
 			data.core = p;
@@ -957,68 +1676,157 @@ namespace tiny {
 					ptr->~T();
 					ptr++;
 				}
-				delete[] (char *)data.core->fragment;
+				detail::free_bytes(data.core->fragment);
 				data.core->fragment = next;
 			}
 		}
+		// replaces the fragment chain with one fragment with room for
+		// capacity characters, or exactly sized if that is less than the
+		// text. false if there was no memory, in which case the chain is
+		// kept.
+		bool internal_join(size_t capacity = 0) const
+		{
+			size_t len = size();
+			if (capacity < len) {
+				capacity = len;
+			}
+			if (capacity > ((size_t)-1 - sizeof(fragment_t)) / sizeof(T)) {
+				return false;
+			}
+			fragment_t *newptr = (fragment_t *)detail::allocate_bytes(sizeof(fragment_t) + sizeof(T) * capacity);
+			if (!newptr) {
+				return false;
+			}
+			newptr->next = 0;
+			newptr->size = capacity;
+			newptr->used = len;
+			memset(&newptr->data[len], 0, sizeof(T));
+			fragment_t *f = data.core->fragment;
+			while (f && len > 0) {
+				len -= f->used;
+				store(f->data, f->data + f->used, newptr->data + len);
+				f = f->next;
+			}
+			internal_clear();
+			data.core->fragment = newptr;
+			return true;
+		}
+		// joins the fragments into one. null if empty, or if there was no
+		// memory to join them, in which case the fragments are kept.
 		T *internal_get() const
 		{
 			if (!data.core->fragment) {
 				return 0;
 			}
 			if (data.core->fragment->next) {
-				size_t len = size();
-				fragment_t *newptr = (fragment_t *)new char [sizeof(fragment_t) + sizeof(T) * len];
-				newptr->next = 0;
-				newptr->size = len;
-				newptr->used = len;
-				memset(&newptr->data[len], 0, sizeof(T));
-				fragment_t *f = data.core->fragment;
-				while (f && len > 0) {
-					len -= f->used;
-					store(f->data, f->data + f->used, newptr->data + len);
-					f = f->next;
+				if (!internal_join()) {
+					return 0;
+				}
+				if (data.core->layout == STRING_AUTO) {
+					// the string is read back after appends; keep it in one piece
+					data.core->layout = STRING_CONTIGUOUS;
 				}
-				internal_clear();
-				data.core->fragment = newptr;
 			}
 			return data.core->fragment->data;
 		}
-		void modify()
+		// position in the text of a pointer into one of the fragments, or
+		// (size_t)-1 if it points elsewhere
+		size_t offset_of(T const *p) const
+		{
+			size_t end = size();
+			for (fragment_t *f = data.core->fragment; f; f = f->next) {
+				end -= f->used;
+				if (p >= f->data && p < f->data + f->used) {
+					return end + (p - f->data);
+				}
+			}
+			return (size_t)-1;
+		}
+		// appends in contiguous layout: the text stays in one fragment,
+		// which is regrown to at least twice its size when full
+		bool append_contiguous(T const *ptr, size_t len)
+		{
+			fragment_t *f = data.core->fragment;
+			if (!f || f->next || f->size - f->used < len) {
+				// ptr may be into this string's own text, which the regrow frees
+				size_t self = offset_of(ptr);
+				size_t used = size();
+				if (len > (size_t)-1 / 2 - used) {
+					return false;
+				}
+				size_t capacity = f && !f->next ? f->size * 2 : 0;
+				if (capacity < used + len) {
+					capacity = used + len;
+				}
+				if (capacity < MIN_FRAGMENT) {
+					capacity = MIN_FRAGMENT;
+				}
+				if (!internal_join(capacity)) {
+					return false;
+				}
+				f = data.core->fragment;
+				if (self != (size_t)-1) {
+					ptr = f->data + self;
+				}
+			}
+			store(ptr, ptr + len, f->data + f->used);
+			f->used += len;
+			f->data[f->used] = 0;
+			return true;
+		}
+		// detaches a shared core before writing to it
+		bool modify()
 		{
 			if (data.core->ref == 1) {
-				return;
+				return true;
+			}
+			t_stringbuffer str;
+			if (literal_of(str.data.core)) {
+				return false;
+			}
+			str.data.core->layout = data.core->layout;
+			if (!str.try_print(c_str(), size())) {
+				return false;
 			}
-			t_stringbuffer str(c_str(), size());
-			assign(str.data.core);
+			// the old core is shared or a literal, so it is never freed here
+			if (!literal_of(data.core)) {
+				data.core->ref--;
+			}
+			data.core = str.data.core;
+			str.data.core = 0;
+			return true;
 		}
 	public:
 		t_stringbuffer()
 		{
-			assign(new core_t());
+			assign(new_core());
 		}
 		t_stringbuffer(T const *ptr)
 		{
-			assign(new core_t());
+			assign(new_core());
 			print(ptr);
 		}
 		t_stringbuffer(T const *ptr, size_t len)
 		{
-			assign(new core_t());
+			assign(new_core());
 			print(ptr, len);
 		}
 		t_stringbuffer(T const *begin, T const *end)
 		{
-			assign(new core_t());
+			assign(new_core());
 			print(begin, end);
 		}
 		t_stringbuffer(t_stringbuffer const &r)
 		{
 			assign(r.data.core);
 		}
-		t_stringbuffer(vector<T> const &vec)
+		t_stringbuffer(basic_literal<T> const &lit)
+		{
+			assign(const_cast<basic_literal<T> *>(&lit));
+		}
+		template <typename S> t_stringbuffer(vector<T, S> const &vec)
 		{
-			assign(new core_t());
+			assign(new_core());
 			if (!vec.empty()) {
 				print(&vec[0], vec.size());
 			}
@@ -1033,40 +1841,99 @@ namespace tiny {
 		}
 		void clear()
 		{
-			modify();
-			internal_clear();
+			if (data.core->ref == 1) {
+				internal_clear();
+			} else {
+				unsigned char layout = data.core->layout;
+				assign(new_core());
+				if (!literal_of(data.core)) {
+					data.core->layout = layout;
+				}
+			}
 		}
-		void print(T const *ptr, size_t len)
+		string_layout layout() const
 		{
-			modify();
-			if (ptr) {
-				if (len > 0) {
-					if (data.core->fragment && data.core->fragment->size > data.core->fragment->used) {
-						size_t n = data.core->fragment->size - data.core->fragment->used;
-						if (n > len) {
-							n = len;
-						}
-						store(ptr, ptr + n, data.core->fragment->data + data.core->fragment->used);
-						data.core->fragment->used += n;
-						data.core->fragment->data[data.core->fragment->used] = 0;
-						ptr += n;
-						len -= n;
-					}
-					if (len > 0) {
-						size_t n = 4096;
-						if (n < len) {
-							n = len;
-						}
-						fragment_t *newptr = (fragment_t *)new char [sizeof(fragment_t) + sizeof(T) * n];
-						newptr->next = data.core->fragment;
-						newptr->size = n;
-						newptr->used = len;
-						store(ptr, ptr + len, newptr->data);
-						newptr->data[newptr->used] = 0;
-						data.core->fragment = newptr;
-					}
+			return (string_layout)data.core->layout;
+		}
+		// a hint; the text is kept. Switching to contiguous joins the
+		// fragments on the next append or c_str(). A shared string is
+		// copied first, so that the strings sharing it keep their layout.
+		void set_layout(string_layout l)
+		{
+			if (data.core->layout == l || !modify()) {
+				return;
+			}
+			data.core->layout = l;
+		}
+		// makes room for n characters in one piece and switches to the
+		// contiguous layout. false if memory runs out.
+		bool reserve(size_t n)
+		{
+			if (!modify()) {
+				return false;
+			}
+			if (data.core->layout == STRING_AUTO) {
+				data.core->layout = STRING_CONTIGUOUS;
+			}
+			fragment_t *f = data.core->fragment;
+			if (n == 0 || (f && !f->next && f->size >= n)) {
+				return true;
+			}
+			return internal_join(n);
+		}
+		// returns false, leaving the string as it was, if memory runs out
+		bool try_print(T const *ptr, size_t len)
+		{
+			if (!ptr || len == 0) {
+				return true;
+			}
+			if (!modify()) {
+				return false;
+			}
+			if (data.core->layout == STRING_CONTIGUOUS) {
+				return append_contiguous(ptr, len);
+			}
+			fragment_t *f = data.core->fragment;
+			size_t n = f ? f->size - f->used : 0;
+			if (n > len) {
+				n = len;
+			}
+			fragment_t *newptr = 0;
+			if (len > n) {
+				// fragments double from MIN_FRAGMENT up to MAX_FRAGMENT, so
+				// short strings stay small and long ones take few blocks
+				size_t size = f ? f->size * 2 : (size_t)MIN_FRAGMENT;
+				if (size > MAX_FRAGMENT) {
+					size = MAX_FRAGMENT;
 				}
+				if (size < len - n) {
+					size = len - n;
+				}
+				newptr = (fragment_t *)detail::allocate_bytes(sizeof(fragment_t) + sizeof(T) * size);
+				if (!newptr) {
+					return false;
+				}
+				newptr->size = size;
+			}
+			if (n > 0) {
+				store(ptr, ptr + n, f->data + f->used);
+				f->used += n;
+				f->data[f->used] = 0;
+				ptr += n;
+				len -= n;
 			}
+			if (newptr) {
+				newptr->next = f;
+				newptr->used = len;
+				store(ptr, ptr + len, newptr->data);
+				newptr->data[newptr->used] = 0;
+				data.core->fragment = newptr;
+			}
+			return true;
+		}
+		void print(T const *ptr, size_t len)
+		{
+			try_print(ptr, len);
 		}
 		void print(T const *begin, T const *end)
 		{
@@ -1086,6 +1953,9 @@ namespace tiny {
 		}
 		size_t size() const
 		{
+			if (basic_literal<T> const *lit = literal_of(data.core)) {
+				return lit->size();
+			}
 			size_t len = 0;
 			fragment_t *f = data.core->fragment;
 			while (f) {
@@ -1098,15 +1968,33 @@ namespace tiny {
 		{
 			return size() == 0;
 		}
+		// merges the fragment chain into one exactly sized block, dropping
+		// the slack at the end of the last fragment. The text is not
+		// changed, so this is done in place even if the core is shared.
+		bool compact()
+		{
+			fragment_t *f = data.core->fragment;
+			if (!f || (!f->next && f->used == f->size)) {
+				return true;
+			}
+			if (f->used == 0 && !f->next) {
+				internal_clear();
+				return true;
+			}
+			return internal_join();
+		}
 		T const *c_str() const
 		{
+			if (basic_literal<T> const *lit = literal_of(data.core)) {
+				return lit->c_str();
+			}
 			T *p = internal_get();
 			return p ? p : zerostring<T>();
 		}
 		int compare(t_stringbuffer const &r) const
 		{
-			if (data.core == r.data.core) return true;
-			if (empty() && r.empty()) return true;
+			if (data.core == r.data.core) return 0;
+			if (empty() && r.empty()) return 0;
 			return t_strcmp(c_str(), r.c_str());
 		}
 		T operator [] (size_t i) const
@@ -1138,17 +2026,17 @@ namespace tiny {
 			return compare(r) >= 0;
 		}
 
-		t_stringbuffer operator += (t_stringbuffer const &s)
+		t_stringbuffer &operator += (t_stringbuffer const &s)
 		{
 			print(s);
 			return *this;
 		}
-		t_stringbuffer operator += (T const *s)
+		t_stringbuffer &operator += (T const *s)
 		{
 			print(s);
 			return *this;
 		}
-		t_stringbuffer operator += (T s)
+		t_stringbuffer &operator += (T s)
 		{
 			print(s);
 			return *this;
@@ -1186,6 +2074,91 @@ namespace tiny {
 
 	typedef t_stringbuffer<char> string;
 
+	template <typename T, typename S> bool compact(vector<T, S> &v)
+	{
+		return v.shrink_to_fit();
+	}
+	template <typename T> bool compact(t_stringbuffer<T> &s)
+	{
+		return s.compact();
+	}
+
+	// Registers a long-lived container with heap_compact(). The hook must
+	// not outlive the container; it unregisters itself when destroyed.
+	// Other types can take part by providing a compact(C &) overload.
+	class compact_hook {
+	private:
+		compact_hook *next;
+		void *obj;
+		bool (*fn)(void *);
+		template <typename C> static bool call(void *p)
+		{
+			return compact(*(C *)p);
+		}
+		static compact_hook *&head()
+		{
+			static compact_hook *p = 0;
+			return p;
+		}
+		compact_hook(compact_hook const &);
+		void operator = (compact_hook const &);
+		friend size_t heap_compact();
+	public:
+		template <typename C> compact_hook(C &c)
+			: next(head())
+			, obj(&c)
+			, fn(&call<C>)
+		{
+			head() = this;
+		}
+		~compact_hook()
+		{
+			compact_hook **p = &head();
+			while (*p) {
+				if (*p == this) {
+					*p = next;
+					break;
+				}
+				p = &(*p)->next;
+			}
+		}
+	};
+
+	// Compacts every registered container, e.g. from loop() while idle.
+	// Returns how many of them could not be compacted for lack of memory.
+	inline size_t heap_compact()
+	{
+		size_t failed = 0;
+		for (compact_hook *h = compact_hook::head(); h; h = h->next) {
+			if (!h->fn(h->obj)) {
+				failed++;
+			}
+		}
+		return failed;
+	}
+
+	// Header sizes for each size policy. On AVR, where pointers and size_t
+	// are 2 bytes and nothing is padded, they come out as:
+	//
+	//                  uint8_t  uint16_t  size_t  heap_header<S>
+	//   vector<T, S>      4         6        6          2
+	//   list<T, S>        5         6        6          -
+	namespace detail {
+		constexpr size_t padded_header(size_t n)
+		{
+			return (n + alignof(void *) - 1) / alignof(void *) * alignof(void *);
+		}
+	}
+	static_assert(sizeof(vector<int, uint8_t>) == detail::padded_header(sizeof(void *) + 2 * sizeof(uint8_t)), "vector<T, uint8_t> header");
+	static_assert(sizeof(vector<int, uint16_t>) == detail::padded_header(sizeof(void *) + 2 * sizeof(uint16_t)), "vector<T, uint16_t> header");
+	static_assert(sizeof(vector<int, size_t>) == detail::padded_header(sizeof(void *) + 2 * sizeof(size_t)), "vector<T, size_t> header");
+	static_assert(sizeof(vector<int, heap_header<uint8_t> >) == sizeof(void *), "vector<T, heap_header<uint8_t> > header");
+	static_assert(sizeof(vector<int, heap_header<uint16_t> >) == sizeof(void *), "vector<T, heap_header<uint16_t> > header");
+	static_assert(sizeof(vector<int, heap_header<size_t> >) == sizeof(void *), "vector<T, heap_header<size_t> > header");
+	static_assert(sizeof(list<int, uint8_t>) == detail::padded_header(2 * sizeof(void *) + sizeof(uint8_t)), "list<T, uint8_t> header");
+	static_assert(sizeof(list<int, uint16_t>) == detail::padded_header(2 * sizeof(void *) + sizeof(uint16_t)), "list<T, uint16_t> header");
+	static_assert(sizeof(list<int, size_t>) == detail::padded_header(2 * sizeof(void *) + sizeof(size_t)), "list<T, size_t> header");
+
 } // namespace tiny
 
 #endif
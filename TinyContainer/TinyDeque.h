@@ -0,0 +1,329 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyDeque_h_
+#define TinyDeque_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Double ended queue in a single circular buffer. The capacity is always
+	// a power of two so that wrapping is a mask, and grows by doubling.
+	template <typename T> class deque {
+	private:
+		size_t capacity;
+		size_t head;
+		size_t count;
+		T *array;
+		T *slot(size_t i) const
+		{
+			return array + ((head + i) & (capacity - 1));
+		}
+		// makes room for n elements. If t is given it is added at the front
+		// or back of the new buffer before the old elements are moved, so
+		// that it may be one of them. false, changing nothing, if memory
+		// runs out.
+		bool grow(size_t n, T const *t = 0, bool front = false)
+		{
+			size_t cap = capacity ? capacity : 8;
+			while (cap < n) {
+				if (cap > (size_t)-1 / 2 / sizeof(T)) {
+					return false;
+				}
+				cap *= 2;
+			}
+			if (cap == capacity) {
+				return true;
+			}
+			T *newarr = (T *)detail::allocate_bytes(sizeof(T) * cap);
+			if (!newarr) {
+				return false;
+			}
+			if (t) {
+				new(newarr + (front ? cap - 1 : count)) T(*t);
+			}
+			if (is_trivially_copyable<T>::value) {
+				size_t n1 = capacity - head;
+				if (n1 > count) n1 = count;
+				if (n1 > 0) memcpy((void *)newarr, (void const *)(array + head), sizeof(T) * n1);
+				if (count > n1) memcpy((void *)(newarr + n1), (void const *)array, sizeof(T) * (count - n1));
+			} else {
+				for (size_t i = 0; i < count; i++) {
+					T *p = slot(i);
+					new(newarr + i) T(*p);
+					p->~T();
+				}
+			}
+			detail::free_bytes(array);
+			array = newarr;
+			capacity = cap;
+			head = t && front ? cap - 1 : 0;
+			if (t) {
+				count++;
+			}
+			return true;
+		}
+	public:
+		deque()
+			: capacity(0)
+			, head(0)
+			, count(0)
+			, array(0)
+		{
+		}
+		deque(deque const &r)
+			: capacity(0)
+			, head(0)
+			, count(0)
+			, array(0)
+		{
+			operator = (r);
+		}
+		~deque()
+		{
+			clear();
+			detail::free_bytes(array);
+		}
+		void operator = (deque const &r)
+		{
+			if (&r == this) return;
+			clear();
+			if (!try_reserve(r.size())) {
+				return;
+			}
+			for (size_t i = 0; i < r.size(); i++) {
+				new(array + i) T(r[i]);
+			}
+			head = 0;
+			count = r.size();
+		}
+
+		template <typename Q, typename V, int D> class iterator_t {
+			friend class deque;
+			template <typename, typename, int> friend class iterator_t;
+		private:
+			Q *q;
+			size_t i;
+			// the positions are compared directly; their difference does
+			// not fit an int in a large deque
+			int compare(iterator_t const &r) const
+			{
+				if (i == r.i) {
+					return 0;
+				}
+				return (i < r.i) == (D > 0) ? -1 : 1;
+			}
+		public:
+			iterator_t(Q *q = 0, size_t i = 0)
+				: q(q)
+				, i(i)
+			{
+			}
+			template <typename Q2, typename V2> iterator_t(iterator_t<Q2, V2, D> const &it)
+				: q(it.q)
+				, i(it.i)
+			{
+			}
+			bool operator == (iterator_t const &it) const
+			{
+				return i == it.i;
+			}
+			bool operator != (iterator_t const &it) const
+			{
+				return !operator == (it);
+			}
+			void operator ++ ()
+			{
+				i += D;
+			}
+			void operator ++ (int)
+			{
+				i += D;
+			}
+			void operator -- ()
+			{
+				i -= D;
+			}
+			void operator -- (int)
+			{
+				i -= D;
+			}
+			V &operator * () const
+			{
+				return *q->slot(D > 0 ? i : i - 1);
+			}
+			V *operator -> () const
+			{
+				return q->slot(D > 0 ? i : i - 1);
+			}
+			iterator_t operator + (size_t n) const
+			{
+				return iterator_t(q, i + D * n);
+			}
+			iterator_t operator - (size_t n) const
+			{
+				return iterator_t(q, i - D * n);
+			}
+			bool operator < (iterator_t const &it) const
+			{
+				return compare(it) < 0;
+			}
+			bool operator > (iterator_t const &it) const
+			{
+				return compare(it) > 0;
+			}
+			bool operator <= (iterator_t const &it) const
+			{
+				return compare(it) <= 0;
+			}
+			bool operator >= (iterator_t const &it) const
+			{
+				return compare(it) >= 0;
+			}
+			size_t operator - (iterator_t const &it) const
+			{
+				return D > 0 ? i - it.i : it.i - i;
+			}
+		};
+		typedef iterator_t<deque, T, 1> iterator;
+		typedef iterator_t<deque const, T const, 1> const_iterator;
+		typedef iterator_t<deque, T, -1> reverse_iterator;
+		typedef iterator_t<deque const, T const, -1> const_reverse_iterator;
+
+		size_t size() const
+		{
+			return count;
+		}
+		bool empty() const
+		{
+			return size() == 0;
+		}
+		// false, leaving the deque as it was, if memory runs out
+		bool try_reserve(size_t n)
+		{
+			return capacity >= n || grow(n);
+		}
+		void reserve(size_t n)
+		{
+			try_reserve(n);
+		}
+		void clear()
+		{
+			for (size_t i = 0; i < count; i++) {
+				slot(i)->~T();
+			}
+			head = 0;
+			count = 0;
+		}
+		void resize(size_t n)
+		{
+			reserve(n);
+			while (size() < n && try_push_back(T())) {
+			}
+			while (size() > n) pop_back();
+		}
+		iterator begin()
+		{
+			return iterator(this, 0);
+		}
+		const_iterator begin() const
+		{
+			return const_iterator(this, 0);
+		}
+		iterator end()
+		{
+			return iterator(this, count);
+		}
+		const_iterator end() const
+		{
+			return const_iterator(this, count);
+		}
+		reverse_iterator rbegin()
+		{
+			return reverse_iterator(this, count);
+		}
+		const_reverse_iterator rbegin() const
+		{
+			return const_reverse_iterator(this, count);
+		}
+		reverse_iterator rend()
+		{
+			return reverse_iterator(this, 0);
+		}
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(this, 0);
+		}
+		// false if memory runs out. t may be an element of this deque.
+		bool try_push_back(T const &t)
+		{
+			if (count == capacity) {
+				return grow(count + 1, &t, false);
+			}
+			new(slot(count)) T(t);
+			count++;
+			return true;
+		}
+		bool try_push_front(T const &t)
+		{
+			if (count == capacity) {
+				return grow(count + 1, &t, true);
+			}
+			head = (head - 1) & (capacity - 1);
+			new(array + head) T(t);
+			count++;
+			return true;
+		}
+		void push_back(T const &t)
+		{
+			try_push_back(t);
+		}
+		void push_front(T const &t)
+		{
+			try_push_front(t);
+		}
+		void pop_back()
+		{
+			if (count > 0) {
+				count--;
+				slot(count)->~T();
+			}
+		}
+		void pop_front()
+		{
+			if (count > 0) {
+				array[head].~T();
+				head = (head + 1) & (capacity - 1);
+				count--;
+			}
+		}
+		T &front()
+		{
+			return array[head];
+		}
+		T const &front() const
+		{
+			return array[head];
+		}
+		T &back()
+		{
+			return *slot(count - 1);
+		}
+		T const &back() const
+		{
+			return *slot(count - 1);
+		}
+		T &operator [] (size_t i)
+		{
+			return *slot(i);
+		}
+		T const &operator [] (size_t i) const
+		{
+			return *slot(i);
+		}
+	};
+
+} // namespace tiny
+
+#endif
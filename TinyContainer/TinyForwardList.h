@@ -0,0 +1,277 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyForwardList_h_
+#define TinyForwardList_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Singly linked list with one pointer per node. Keeps a pointer to the
+	// last node as well, so it works both as a stack (push_front/pop_front)
+	// and as a queue (push_back/pop_front).
+	template <typename T> class forward_list {
+	private:
+		struct node_t {
+			node_t *next;
+			T val;
+			node_t(T const &v)
+				: next(0)
+				, val(v)
+			{
+			}
+		};
+		node_t *first;
+		node_t *last;
+		size_t count;
+		static node_t *new_node(T const &v)
+		{
+			void *p = detail::allocate_bytes(sizeof(node_t));
+			return p ? new(p) node_t(v) : 0;
+		}
+		static void free_node(node_t *node)
+		{
+			node->~node_t();
+			detail::free_bytes(node);
+		}
+	public:
+		forward_list()
+			: first(0)
+			, last(0)
+			, count(0)
+		{
+		}
+		forward_list(forward_list const &r)
+			: first(0)
+			, last(0)
+			, count(0)
+		{
+			for (const_iterator it = r.begin(); it != r.end(); it++) {
+				if (!try_push_back(*it)) break;
+			}
+		}
+		~forward_list()
+		{
+			clear();
+		}
+		void operator = (forward_list const &r)
+		{
+			if (&r == this) return;
+			clear();
+			for (const_iterator it = r.begin(); it != r.end(); it++) {
+				if (!try_push_back(*it)) break;
+			}
+		}
+		size_t size() const
+		{
+			return count;
+		}
+		bool empty() const
+		{
+			return size() == 0;
+		}
+		void clear()
+		{
+			while (first) {
+				pop_front();
+			}
+		}
+		class const_iterator;
+		class iterator {
+			friend class forward_list;
+			friend class const_iterator;
+		private:
+			node_t *node;
+		public:
+			iterator(node_t *node)
+				: node(node)
+			{
+			}
+			bool operator == (iterator const &it) const
+			{
+				return node == it.node;
+			}
+			bool operator != (iterator const &it) const
+			{
+				return !operator == (it);
+			}
+			void operator ++ ()
+			{
+				TINY_CHECK(node, "forward_list iterator moved past the end");
+				node = node->next;
+			}
+			void operator ++ (int)
+			{
+				TINY_CHECK(node, "forward_list iterator moved past the end");
+				node = node->next;
+			}
+			iterator operator + (size_t n) const
+			{
+				iterator it(node);
+				for (; n > 0; n--) it++;
+				return it;
+			}
+			T &operator * ()
+			{
+				TINY_CHECK(node, "forward_list iterator dereferenced at the end");
+				return node->val;
+			}
+			T *operator -> ()
+			{
+				TINY_CHECK(node, "forward_list iterator dereferenced at the end");
+				return &node->val;
+			}
+		};
+		class const_iterator {
+			friend class forward_list;
+		private:
+			node_t const *node;
+		public:
+			const_iterator(node_t const *node)
+				: node(node)
+			{
+			}
+			const_iterator(iterator const &it)
+				: node(it.node)
+			{
+			}
+			bool operator == (const_iterator const &it) const
+			{
+				return node == it.node;
+			}
+			bool operator != (const_iterator const &it) const
+			{
+				return !operator == (it);
+			}
+			void operator ++ ()
+			{
+				TINY_CHECK(node, "forward_list iterator moved past the end");
+				node = node->next;
+			}
+			void operator ++ (int)
+			{
+				TINY_CHECK(node, "forward_list iterator moved past the end");
+				node = node->next;
+			}
+			const_iterator operator + (size_t n) const
+			{
+				const_iterator it(node);
+				for (; n > 0; n--) it++;
+				return it;
+			}
+			T const &operator * () const
+			{
+				TINY_CHECK(node, "forward_list iterator dereferenced at the end");
+				return node->val;
+			}
+			T const *operator -> () const
+			{
+				TINY_CHECK(node, "forward_list iterator dereferenced at the end");
+				return &node->val;
+			}
+		};
+		iterator begin()
+		{
+			return iterator(first);
+		}
+		const_iterator begin() const
+		{
+			return const_iterator(first);
+		}
+		iterator end()
+		{
+			return iterator(0);
+		}
+		const_iterator end() const
+		{
+			return const_iterator(0);
+		}
+		T &front()
+		{
+			return first->val;
+		}
+		T const &front() const
+		{
+			return first->val;
+		}
+		T &back()
+		{
+			return last->val;
+		}
+		T const &back() const
+		{
+			return last->val;
+		}
+		// false if memory runs out
+		bool try_push_front(T const &v)
+		{
+			node_t *node = new_node(v);
+			if (!node) return false;
+			node->next = first;
+			first = node;
+			if (!last) last = node;
+			count++;
+			return true;
+		}
+		bool try_push_back(T const &v)
+		{
+			node_t *node = new_node(v);
+			if (!node) return false;
+			if (last) {
+				last->next = node;
+			} else {
+				first = node;
+			}
+			last = node;
+			count++;
+			return true;
+		}
+		void push_front(T const &v)
+		{
+			try_push_front(v);
+		}
+		void push_back(T const &v)
+		{
+			try_push_back(v);
+		}
+		void pop_front()
+		{
+			if (first) {
+				node_t *node = first;
+				first = node->next;
+				if (!first) last = 0;
+				count--;
+				free_node(node);
+			}
+		}
+		// end() if memory runs out
+		iterator insert_after(iterator it, T const &v)
+		{
+			if (!it.node) {
+				return try_push_back(v) ? iterator(last) : end();
+			}
+			node_t *node = new_node(v);
+			if (!node) return end();
+			node->next = it.node->next;
+			it.node->next = node;
+			if (last == it.node) last = node;
+			count++;
+			return iterator(node);
+		}
+		// removes the element following it and returns the one after that
+		iterator erase_after(iterator it)
+		{
+			if (!it.node || !it.node->next) return end();
+			node_t *node = it.node->next;
+			it.node->next = node->next;
+			if (last == node) last = it.node;
+			count--;
+			free_node(node);
+			return iterator(it.node->next);
+		}
+	};
+
+} // namespace tiny
+
+#endif
@@ -0,0 +1,308 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyIntrusiveList_h_
+#define TinyIntrusiveList_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Embed a list_hook in your object and the list uses it for the links,
+	// so linking an object never allocates:
+	//
+	//   struct timer_t {
+	//       unsigned long deadline;
+	//       tiny::list_hook hook;
+	//   };
+	//   tiny::intrusive_list<timer_t, &timer_t::hook> timers;
+	//
+	// An object can take itself out of whatever list it is in with
+	// hook.unlink(), and does so automatically when destroyed. Because of
+	// that the list does not keep a count, and size() is O(n).
+	class list_hook {
+		template <typename T, list_hook T::*Hook> friend class intrusive_list;
+	private:
+		list_hook *next;
+		list_hook *prev;
+		void link_before(list_hook *pos)
+		{
+			next = pos;
+			prev = pos->prev;
+			prev->next = this;
+			pos->prev = this;
+		}
+	public:
+		list_hook()
+			: next(0)
+			, prev(0)
+		{
+		}
+		list_hook(list_hook const &)
+			: next(0)
+			, prev(0)
+		{
+		}
+		~list_hook()
+		{
+			unlink();
+		}
+		void operator = (list_hook const &)
+		{
+		}
+		bool linked() const
+		{
+			return next != 0;
+		}
+		void unlink()
+		{
+			if (next) {
+				next->prev = prev;
+				prev->next = next;
+				next = 0;
+				prev = 0;
+			}
+		}
+	};
+
+	template <typename T, list_hook T::*Hook> class intrusive_list {
+	private:
+		list_hook root;
+		// where the hook sits in a T. Measured on storage the size and
+		// alignment of a T rather than through a null pointer; the
+		// compiler folds it to a constant.
+		static size_t offset()
+		{
+			alignas(T) char storage[sizeof(T)];
+			T *p = (T *)storage;
+			return (char *)&(p->*Hook) - storage;
+		}
+		static T *object(list_hook *h)
+		{
+			return (T *)((char *)h - offset());
+		}
+		static T const *object(list_hook const *h)
+		{
+			return (T const *)((char const *)h - offset());
+		}
+		intrusive_list(intrusive_list const &);
+		void operator = (intrusive_list const &);
+	public:
+		intrusive_list()
+		{
+			root.next = &root;
+			root.prev = &root;
+		}
+		~intrusive_list()
+		{
+			clear();
+			root.next = 0;
+		}
+		size_t size() const
+		{
+			size_t n = 0;
+			for (list_hook const *h = root.next; h != &root; h = h->next) {
+				n++;
+			}
+			return n;
+		}
+		bool empty() const
+		{
+			return root.next == &root;
+		}
+		void clear()
+		{
+			while (!empty()) {
+				root.next->unlink();
+			}
+		}
+		class const_iterator;
+		class iterator {
+			friend class intrusive_list;
+			friend class const_iterator;
+		private:
+			list_hook *node;
+		public:
+			iterator(list_hook *node)
+				: node(node)
+			{
+			}
+			bool operator == (iterator const &it) const
+			{
+				return node == it.node;
+			}
+			bool operator != (iterator const &it) const
+			{
+				return !operator == (it);
+			}
+			void operator ++ ()
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->next;
+			}
+			void operator ++ (int)
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->next;
+			}
+			void operator -- ()
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->prev;
+			}
+			void operator -- (int)
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->prev;
+			}
+			iterator operator + (size_t n) const
+			{
+				iterator it(node);
+				for (; n > 0; n--) it++;
+				return it;
+			}
+			iterator operator - (size_t n) const
+			{
+				iterator it(node);
+				for (; n > 0; n--) it--;
+				return it;
+			}
+			T &operator * ()
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				return *object(node);
+			}
+			T *operator -> ()
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				return object(node);
+			}
+		};
+		class const_iterator {
+			friend class intrusive_list;
+		private:
+			list_hook const *node;
+		public:
+			const_iterator(list_hook const *node)
+				: node(node)
+			{
+			}
+			const_iterator(iterator const &it)
+				: node(it.node)
+			{
+			}
+			bool operator == (const_iterator const &it) const
+			{
+				return node == it.node;
+			}
+			bool operator != (const_iterator const &it) const
+			{
+				return !operator == (it);
+			}
+			void operator ++ ()
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->next;
+			}
+			void operator ++ (int)
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->next;
+			}
+			void operator -- ()
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->prev;
+			}
+			void operator -- (int)
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				node = node->prev;
+			}
+			const_iterator operator + (size_t n) const
+			{
+				const_iterator it(node);
+				for (; n > 0; n--) it++;
+				return it;
+			}
+			const_iterator operator - (size_t n) const
+			{
+				const_iterator it(node);
+				for (; n > 0; n--) it--;
+				return it;
+			}
+			T const &operator * () const
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				return *object(node);
+			}
+			T const *operator -> () const
+			{
+				TINY_CHECK(node->next, "intrusive_list iterator to an unlinked element");
+				return object(node);
+			}
+		};
+		iterator begin()
+		{
+			return iterator(root.next);
+		}
+		const_iterator begin() const
+		{
+			return const_iterator(root.next);
+		}
+		iterator end()
+		{
+			return iterator(&root);
+		}
+		const_iterator end() const
+		{
+			return const_iterator(&root);
+		}
+		static iterator iterator_to(T &v)
+		{
+			return iterator(&(v.*Hook));
+		}
+		T &front()
+		{
+			return *object(root.next);
+		}
+		T &back()
+		{
+			return *object(root.prev);
+		}
+		// if v is linked into a list already, it is moved
+		iterator insert(iterator it, T &v)
+		{
+			list_hook *h = &(v.*Hook);
+			if (h == it.node) return it;
+			h->unlink();
+			h->link_before(it.node);
+			return iterator(h);
+		}
+		iterator erase(iterator it)
+		{
+			list_hook *next = it.node->next;
+			it.node->unlink();
+			return iterator(next);
+		}
+		void push_back(T &v)
+		{
+			insert(end(), v);
+		}
+		void push_front(T &v)
+		{
+			insert(begin(), v);
+		}
+		void pop_back()
+		{
+			if (!empty()) root.prev->unlink();
+		}
+		void pop_front()
+		{
+			if (!empty()) root.next->unlink();
+		}
+	};
+
+} // namespace tiny
+
+#endif
@@ -0,0 +1,225 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyLineReader_h_
+#define TinyLineReader_h_
+
+#include "TinyView.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINY_HAVE_FD 1
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+namespace tiny {
+
+	// Sources for line_reader. read(buf, n) returns the number of bytes
+	// stored, 0 if none are available right now, or -1 at the end of the
+	// input. Anything with that member can be used.
+
+	// Arduino Stream, or anything with available() and read(). Never ends.
+	template <typename S> class stream_source {
+	private:
+		S *stream;
+	public:
+		stream_source(S &s)
+			: stream(&s)
+		{
+		}
+		int read(char *buf, size_t n)
+		{
+			int avail = stream->available();
+			size_t i = 0;
+			while (avail-- > 0 && i < n) {
+				int c = stream->read();
+				if (c < 0) break;
+				buf[i++] = (char)c;
+			}
+			return (int)i;
+		}
+	};
+
+	class memory_source {
+	private:
+		char const *ptr;
+		size_t left;
+	public:
+		memory_source(void const *data, size_t size)
+			: ptr((char const *)data)
+			, left(size)
+		{
+		}
+		int read(char *buf, size_t n)
+		{
+			if (left == 0) return -1;
+			if (n > left) n = left;
+			if (n > 0x7fff) n = 0x7fff;
+			memcpy(buf, ptr, n);
+			ptr += n;
+			left -= n;
+			return (int)n;
+		}
+	};
+
+#ifdef TINY_HAVE_FD
+	// POSIX file descriptor, blocking or not. Does not close it.
+	class fd_source {
+	private:
+		int fd;
+	public:
+		fd_source(int fd)
+			: fd(fd)
+		{
+		}
+		int read(char *buf, size_t n)
+		{
+			if (n > 0x7fff) n = 0x7fff;
+			ssize_t r = ::read(fd, buf, n);
+			if (r > 0) return (int)r;
+			if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+			return -1;
+		}
+	};
+#endif
+
+	// Splits the bytes of a source into records without allocating per
+	// record. Bytes are read into one buffer that is allocated up front;
+	// each record is returned as a view into it that stays valid until the
+	// next call. A line longer than the buffer comes back in buffer sized
+	// pieces marked PARTIAL, followed by its last piece as RECORD.
+	template <typename Source> class line_reader {
+	public:
+		enum status {
+			RECORD,    // a complete record, or the last piece of a long one
+			PARTIAL,   // a piece of a record that continues
+			NEED_MORE, // the source has no more bytes right now; call again later
+			END,       // end of input
+		};
+	private:
+		Source src;
+		char *buf;
+		size_t cap;
+		size_t head; // start of unconsumed bytes
+		size_t tail; // end of valid bytes
+		size_t scan; // bytes from head already searched for a newline
+		bool eof;
+		bool continued; // the last line was returned as PARTIAL
+		line_reader(line_reader const &);
+		void operator = (line_reader const &);
+
+		// moves the unconsumed bytes to the front and reads more after them
+		int fill()
+		{
+			if (eof) return -1;
+			if (head > 0) {
+				memmove(buf, buf + head, tail - head);
+				tail -= head;
+				head = 0;
+			}
+			if (tail == cap) return 0;
+			int r = src.read(buf + tail, cap - tail);
+			if (r < 0) {
+				eof = true;
+				return -1;
+			}
+			tail += r;
+			return r;
+		}
+		string_view take(size_t n, size_t skip)
+		{
+			string_view v(buf + head, n);
+			head += n + skip;
+			scan = 0;
+			return v;
+		}
+	public:
+		// capacity is the longest line returned in one piece. A capacity
+		// of 0 is refused like a failed allocation: valid() is false.
+		line_reader(Source const &src, size_t capacity = 256)
+			: src(src)
+			, buf(capacity ? (char *)detail::allocate_bytes(capacity) : 0)
+			, cap(buf ? capacity : 0)
+			, head(0)
+			, tail(0)
+			, scan(0)
+			, eof(false)
+			, continued(false)
+		{
+		}
+		~line_reader()
+		{
+			detail::free_bytes(buf);
+		}
+		// false if the buffer could not be allocated or capacity was 0
+		bool valid() const
+		{
+			return buf != 0;
+		}
+		Source &source()
+		{
+			return src;
+		}
+		// next newline terminated line, without the newline or a \r before it
+		status next(string_view *out)
+		{
+			if (!buf) return END;
+			while (1) {
+				size_t n = tail - head;
+				char const *p = scan < n ? (char const *)memchr(buf + head + scan, '\n', n - scan) : 0;
+				if (p) {
+					size_t len = p - (buf + head);
+					size_t cr = len > 0 && p[-1] == '\r' ? 1 : 0;
+					*out = take(len - cr, 1 + cr);
+					continued = false;
+					return RECORD;
+				}
+				scan = n;
+				if (n == cap) {
+					// no newline in a full buffer; keep a trailing \r for the next piece
+					size_t len = buf[tail - 1] == '\r' && n > 1 ? n - 1 : n;
+					*out = take(len, 0);
+					continued = true;
+					return PARTIAL;
+				}
+				int r = fill();
+				if (r == 0) return NEED_MORE;
+				if (r < 0) {
+					// the input ended without a newline
+					if (head < tail || continued) {
+						*out = take(tail - head, 0);
+						continued = false;
+						return RECORD;
+					}
+					*out = string_view();
+					return END;
+				}
+			}
+		}
+		// next n bytes, for length delimited records. If n is larger than
+		// the buffer, the record comes in PARTIAL pieces; call again with
+		// what is left of n after each.
+		status next_block(size_t n, string_view *out)
+		{
+			if (!buf) return END;
+			size_t want = n < cap ? n : cap;
+			while (tail - head < want) {
+				int r = fill();
+				if (r == 0) return NEED_MORE;
+				if (r < 0) {
+					if (head < tail) {
+						*out = take(tail - head, 0);
+						return PARTIAL;
+					}
+					*out = string_view();
+					return END;
+				}
+			}
+			*out = take(want, 0);
+			return want == n ? RECORD : PARTIAL;
+		}
+	};
+
+} // namespace tiny
+
+#endif
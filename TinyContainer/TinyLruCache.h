@@ -0,0 +1,250 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyLruCache_h_
+#define TinyLruCache_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Default hash for integral and enum keys. Specialize it for other key types.
+	template <typename K> struct hash {
+		size_t operator () (K const &k) const
+		{
+			uint32_t x = (uint32_t)k;
+			if (sizeof(K) > 4) {
+				x ^= (uint32_t)((unsigned long long)k >> 32);
+			}
+			x ^= x >> 16;
+			x *= 0x7feb352dUL;
+			x ^= x >> 15;
+			x *= 0x846ca68bUL;
+			x ^= x >> 16;
+			return x;
+		}
+	};
+
+	template <typename T> struct hash<t_stringbuffer<T> > {
+		size_t operator () (t_stringbuffer<T> const &s) const
+		{
+			uint32_t x = 2166136261UL;
+			T const *p = s.c_str();
+			for (size_t i = 0, n = s.size(); i < n; i++) {
+				x = (x ^ (uint32_t)p[i]) * 16777619UL;
+			}
+			return x;
+		}
+	};
+
+	namespace detail {
+		constexpr size_t pow2_ceil(size_t n, size_t p = 1)
+		{
+			return p >= n ? p : pow2_ceil(n, p * 2);
+		}
+
+		// smallest unsigned type that can hold 0..N
+		template <size_t N, bool Small = (N < 0xff), bool Medium = (N < 0xffff)> struct index_type {
+			typedef uint32_t type;
+		};
+		template <size_t N, bool Medium> struct index_type<N, true, Medium> {
+			typedef uint8_t type;
+		};
+		template <size_t N> struct index_type<N, false, true> {
+			typedef uint16_t type;
+		};
+	}
+
+	// Fixed capacity LRU cache. All storage is inside the object: entries
+	// are preallocated, recency is a doubly linked list of entry indices
+	// and the key index is a linear probing hash table with twice as many
+	// slots as entries. get, put and eviction are O(1) and never allocate.
+	template <typename K, typename V, size_t Capacity, typename Hash = hash<K> > class lru_cache {
+	private:
+		typedef typename detail::index_type<Capacity>::type index_t;
+		enum {
+			NIL = Capacity,
+			TABLE_SIZE = detail::pow2_ceil(Capacity * 2),
+		};
+		struct entry_t {
+			K key;
+			V value;
+			index_t prev;
+			index_t next;
+		};
+		entry_t entries[Capacity];
+		index_t table[TABLE_SIZE]; // entry index + 1, or 0 if empty
+		index_t head; // most recently used
+		index_t tail; // least recently used
+		index_t free_entry;
+		size_t count;
+		unsigned long hit_count;
+		unsigned long miss_count;
+		unsigned long eviction_count;
+		Hash hasher;
+
+		size_t home(K const &k) const
+		{
+			return hasher(k) & (TABLE_SIZE - 1);
+		}
+		// slot holding k, or the empty slot where it would go
+		size_t probe(K const &k) const
+		{
+			size_t i = home(k);
+			while (table[i] && !(entries[table[i] - 1].key == k)) {
+				i = (i + 1) & (TABLE_SIZE - 1);
+			}
+			return i;
+		}
+		void unindex(size_t i)
+		{
+			// backward shift deletion, so lookups never see tombstones
+			while (1) {
+				table[i] = 0;
+				size_t j = i;
+				while (1) {
+					j = (j + 1) & (TABLE_SIZE - 1);
+					if (!table[j]) return;
+					size_t h = home(entries[table[j] - 1].key);
+					bool stays = i < j ? (i < h && h <= j) : (i < h || h <= j);
+					if (!stays) break;
+				}
+				table[i] = table[j];
+				i = j;
+			}
+		}
+		void unlink(index_t e)
+		{
+			entry_t &t = entries[e];
+			if (t.prev != NIL) entries[t.prev].next = t.next; else head = t.next;
+			if (t.next != NIL) entries[t.next].prev = t.prev; else tail = t.prev;
+		}
+		void link_front(index_t e)
+		{
+			entry_t &t = entries[e];
+			t.prev = NIL;
+			t.next = head;
+			if (head != NIL) entries[head].prev = e; else tail = e;
+			head = e;
+		}
+		void touch(index_t e)
+		{
+			if (head != e) {
+				unlink(e);
+				link_front(e);
+			}
+		}
+	public:
+		lru_cache(Hash const &hasher = Hash())
+			: hasher(hasher)
+		{
+			clear();
+			reset_stats();
+		}
+		static size_t capacity()
+		{
+			return Capacity;
+		}
+		size_t size() const
+		{
+			return count;
+		}
+		bool empty() const
+		{
+			return count == 0;
+		}
+		void clear()
+		{
+			memset(table, 0, sizeof(table));
+			head = NIL;
+			tail = NIL;
+			for (size_t i = 0; i < Capacity; i++) {
+				entries[i].next = (index_t)(i + 1);
+			}
+			free_entry = 0;
+			count = 0;
+		}
+		// returns the cached value and marks it most recently used, or null
+		V *get(K const &k)
+		{
+			size_t i = probe(k);
+			if (!table[i]) {
+				miss_count++;
+				return 0;
+			}
+			hit_count++;
+			index_t e = table[i] - 1;
+			touch(e);
+			return &entries[e].value;
+		}
+		// like get() but leaves the recency order and the counters alone
+		V const *peek(K const &k) const
+		{
+			size_t i = probe(k);
+			return table[i] ? &entries[table[i] - 1].value : 0;
+		}
+		bool contains(K const &k) const
+		{
+			return table[probe(k)] != 0;
+		}
+		void put(K const &k, V const &v)
+		{
+			size_t i = probe(k);
+			if (table[i]) {
+				index_t e = table[i] - 1;
+				entries[e].value = v;
+				touch(e);
+				return;
+			}
+			index_t e;
+			if (free_entry != NIL) {
+				e = free_entry;
+				free_entry = entries[e].next;
+				count++;
+			} else {
+				e = tail;
+				unlink(e);
+				unindex(probe(entries[e].key));
+				eviction_count++;
+				i = probe(k);
+			}
+			entries[e].key = k;
+			entries[e].value = v;
+			link_front(e);
+			table[i] = e + 1;
+		}
+		bool erase(K const &k)
+		{
+			size_t i = probe(k);
+			if (!table[i]) return false;
+			index_t e = table[i] - 1;
+			unindex(i);
+			unlink(e);
+			entries[e].next = free_entry;
+			free_entry = e;
+			count--;
+			return true;
+		}
+		unsigned long hits() const
+		{
+			return hit_count;
+		}
+		unsigned long misses() const
+		{
+			return miss_count;
+		}
+		unsigned long evictions() const
+		{
+			return eviction_count;
+		}
+		void reset_stats()
+		{
+			hit_count = 0;
+			miss_count = 0;
+			eviction_count = 0;
+		}
+	};
+
+} // namespace tiny
+
+#endif
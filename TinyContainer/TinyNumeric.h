@@ -0,0 +1,443 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyNumeric_h_
+#define TinyNumeric_h_
+
+#include "TinyContainer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TINY_HAVE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TINY_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace tiny {
+
+	// Numeric kernels over plain arrays, with overloads for vector. The
+	// generic versions are simple loops over raw pointers that host
+	// compilers vectorize on their own; int16_t and float, the types of
+	// the signal path, also get explicit SSE2 or NEON kernels. On AVR
+	// everything is the scalar loop.
+	namespace numeric {
+
+		static const size_t npos = (size_t)-1;
+
+		// type sums and dot products are accumulated in
+		template <typename T> struct accum {
+			typedef T type;
+		};
+		template <> struct accum<int8_t> {
+			typedef int32_t type;
+		};
+		template <> struct accum<uint8_t> {
+			typedef uint32_t type;
+		};
+		template <> struct accum<int16_t> {
+			typedef int32_t type;
+		};
+		template <> struct accum<uint16_t> {
+			typedef uint32_t type;
+		};
+
+		namespace detail {
+			template <typename T> typename accum<T>::type sum(T const *p, size_t n)
+			{
+				typedef typename accum<T>::type A;
+				// independent partial sums, so floating point adds can overlap
+				A s0 = A(), s1 = A(), s2 = A(), s3 = A();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					s0 += p[i];
+					s1 += p[i + 1];
+					s2 += p[i + 2];
+					s3 += p[i + 3];
+				}
+				for (; i < n; i++) {
+					s0 += p[i];
+				}
+				return (s0 + s1) + (s2 + s3);
+			}
+
+			template <typename T> typename accum<T>::type dot(T const *a, T const *b, size_t n)
+			{
+				typedef typename accum<T>::type A;
+				A s0 = A(), s1 = A(), s2 = A(), s3 = A();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					s0 += (A)a[i] * b[i];
+					s1 += (A)a[i + 1] * b[i + 1];
+					s2 += (A)a[i + 2] * b[i + 2];
+					s3 += (A)a[i + 3] * b[i + 3];
+				}
+				for (; i < n; i++) {
+					s0 += (A)a[i] * b[i];
+				}
+				return (s0 + s1) + (s2 + s3);
+			}
+
+			template <typename T> void minmax(T const *p, size_t n, T *lo, T *hi)
+			{
+				T mn = p[0];
+				T mx = p[0];
+				for (size_t i = 1; i < n; i++) {
+					mn = p[i] < mn ? p[i] : mn;
+					mx = mx < p[i] ? p[i] : mx;
+				}
+				*lo = mn;
+				*hi = mx;
+			}
+
+#if defined(TINY_HAVE_SSE2)
+			inline int32_t hsum(__m128i v)
+			{
+				v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+				v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_cvtsi128_si32(v);
+			}
+			inline float hsum(__m128 v)
+			{
+				v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+				v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+				return _mm_cvtss_f32(v);
+			}
+
+			inline int32_t sum(int16_t const *p, size_t n)
+			{
+				__m128i ones = _mm_set1_epi16(1);
+				__m128i acc = _mm_setzero_si128();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					__m128i v = _mm_loadu_si128((__m128i const *)(p + i));
+					acc = _mm_add_epi32(acc, _mm_madd_epi16(v, ones));
+				}
+				int32_t s = hsum(acc);
+				for (; i < n; i++) {
+					s += p[i];
+				}
+				return s;
+			}
+			inline int32_t dot(int16_t const *a, int16_t const *b, size_t n)
+			{
+				__m128i acc = _mm_setzero_si128();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					__m128i va = _mm_loadu_si128((__m128i const *)(a + i));
+					__m128i vb = _mm_loadu_si128((__m128i const *)(b + i));
+					acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+				}
+				int32_t s = hsum(acc);
+				for (; i < n; i++) {
+					s += (int32_t)a[i] * b[i];
+				}
+				return s;
+			}
+			inline void minmax(int16_t const *p, size_t n, int16_t *lo, int16_t *hi)
+			{
+				if (n < 8) {
+					minmax<int16_t>(p, n, lo, hi);
+					return;
+				}
+				__m128i mn = _mm_loadu_si128((__m128i const *)p);
+				__m128i mx = mn;
+				size_t i = 8;
+				for (; i + 8 <= n; i += 8) {
+					__m128i v = _mm_loadu_si128((__m128i const *)(p + i));
+					mn = _mm_min_epi16(mn, v);
+					mx = _mm_max_epi16(mx, v);
+				}
+				int16_t a[8], b[8];
+				_mm_storeu_si128((__m128i *)a, mn);
+				_mm_storeu_si128((__m128i *)b, mx);
+				int16_t l = a[0], h = b[0];
+				for (int k = 1; k < 8; k++) {
+					l = a[k] < l ? a[k] : l;
+					h = h < b[k] ? b[k] : h;
+				}
+				for (; i < n; i++) {
+					l = p[i] < l ? p[i] : l;
+					h = h < p[i] ? p[i] : h;
+				}
+				*lo = l;
+				*hi = h;
+			}
+			inline float sum(float const *p, size_t n)
+			{
+				__m128 acc0 = _mm_setzero_ps();
+				__m128 acc1 = _mm_setzero_ps();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					acc0 = _mm_add_ps(acc0, _mm_loadu_ps(p + i));
+					acc1 = _mm_add_ps(acc1, _mm_loadu_ps(p + i + 4));
+				}
+				float s = hsum(_mm_add_ps(acc0, acc1));
+				for (; i < n; i++) {
+					s += p[i];
+				}
+				return s;
+			}
+			inline float dot(float const *a, float const *b, size_t n)
+			{
+				__m128 acc0 = _mm_setzero_ps();
+				__m128 acc1 = _mm_setzero_ps();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+					acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+				}
+				float s = hsum(_mm_add_ps(acc0, acc1));
+				for (; i < n; i++) {
+					s += a[i] * b[i];
+				}
+				return s;
+			}
+#elif defined(TINY_HAVE_NEON)
+			inline int32_t hsum(int32x4_t v)
+			{
+				int32x2_t t = vadd_s32(vget_low_s32(v), vget_high_s32(v));
+				return vget_lane_s32(vpadd_s32(t, t), 0);
+			}
+			inline float hsum(float32x4_t v)
+			{
+				float32x2_t t = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+				return vget_lane_f32(vpadd_f32(t, t), 0);
+			}
+
+			inline int32_t sum(int16_t const *p, size_t n)
+			{
+				int32x4_t acc = vdupq_n_s32(0);
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					acc = vpadalq_s16(acc, vld1q_s16(p + i));
+				}
+				int32_t s = hsum(acc);
+				for (; i < n; i++) {
+					s += p[i];
+				}
+				return s;
+			}
+			inline int32_t dot(int16_t const *a, int16_t const *b, size_t n)
+			{
+				int32x4_t acc = vdupq_n_s32(0);
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					int16x8_t va = vld1q_s16(a + i);
+					int16x8_t vb = vld1q_s16(b + i);
+					acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+					acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+				}
+				int32_t s = hsum(acc);
+				for (; i < n; i++) {
+					s += (int32_t)a[i] * b[i];
+				}
+				return s;
+			}
+			inline void minmax(int16_t const *p, size_t n, int16_t *lo, int16_t *hi)
+			{
+				if (n < 8) {
+					minmax<int16_t>(p, n, lo, hi);
+					return;
+				}
+				int16x8_t mn = vld1q_s16(p);
+				int16x8_t mx = mn;
+				size_t i = 8;
+				for (; i + 8 <= n; i += 8) {
+					int16x8_t v = vld1q_s16(p + i);
+					mn = vminq_s16(mn, v);
+					mx = vmaxq_s16(mx, v);
+				}
+				int16_t a[8], b[8];
+				vst1q_s16(a, mn);
+				vst1q_s16(b, mx);
+				int16_t l = a[0], h = b[0];
+				for (int k = 1; k < 8; k++) {
+					l = a[k] < l ? a[k] : l;
+					h = h < b[k] ? b[k] : h;
+				}
+				for (; i < n; i++) {
+					l = p[i] < l ? p[i] : l;
+					h = h < p[i] ? p[i] : h;
+				}
+				*lo = l;
+				*hi = h;
+			}
+			inline float sum(float const *p, size_t n)
+			{
+				float32x4_t acc0 = vdupq_n_f32(0);
+				float32x4_t acc1 = vdupq_n_f32(0);
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					acc0 = vaddq_f32(acc0, vld1q_f32(p + i));
+					acc1 = vaddq_f32(acc1, vld1q_f32(p + i + 4));
+				}
+				float s = hsum(vaddq_f32(acc0, acc1));
+				for (; i < n; i++) {
+					s += p[i];
+				}
+				return s;
+			}
+			inline float dot(float const *a, float const *b, size_t n)
+			{
+				float32x4_t acc0 = vdupq_n_f32(0);
+				float32x4_t acc1 = vdupq_n_f32(0);
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+					acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+				}
+				float s = hsum(vaddq_f32(acc0, acc1));
+				for (; i < n; i++) {
+					s += a[i] * b[i];
+				}
+				return s;
+			}
+#endif
+
+			template <typename T, typename S> T const *data_of(vector<T, S> const &v)
+			{
+				return v.empty() ? 0 : &v[0];
+			}
+			template <typename T, typename S> T *data_of(vector<T, S> &v)
+			{
+				return v.empty() ? 0 : &v[0];
+			}
+		}
+
+		template <typename T> typename accum<T>::type accumulate(T const *p, size_t n)
+		{
+			return detail::sum(p, n);
+		}
+		template <typename T, typename A> A accumulate(T const *p, size_t n, A init)
+		{
+			return init + (A)detail::sum(p, n);
+		}
+
+		// a and b must both hold n elements
+		template <typename T> typename accum<T>::type dot(T const *a, T const *b, size_t n)
+		{
+			return detail::dot(a, b, n);
+		}
+
+		// false, leaving lo and hi alone, if n is 0
+		template <typename T> bool minmax(T const *p, size_t n, T *lo, T *hi)
+		{
+			if (n == 0) {
+				return false;
+			}
+			detail::minmax(p, n, lo, hi);
+			return true;
+		}
+
+		// dst[i] = op(src[i]). dst may be src.
+		template <typename T, typename U, typename Op> void transform(U *dst, T const *src, size_t n, Op op)
+		{
+			for (size_t i = 0; i < n; i++) {
+				dst[i] = op(src[i]);
+			}
+		}
+
+		template <typename T> void fill(T *p, size_t n, T const &v)
+		{
+			if (sizeof(T) == 1) {
+				if (n > 0) {
+					memset((void *)p, *(unsigned char const *)&v, n);
+				}
+			} else {
+				for (size_t i = 0; i < n; i++) {
+					p[i] = v;
+				}
+			}
+		}
+
+		template <typename T> size_t count(T const *p, size_t n, T const &v)
+		{
+			size_t c = 0;
+			for (size_t i = 0; i < n; i++) {
+				c += p[i] == v;
+			}
+			return c;
+		}
+
+		// index of the first element equal to v, or npos
+		template <typename T> size_t find(T const *p, size_t n, T const &v)
+		{
+			if (sizeof(T) == 1) {
+				void const *q = n > 0 ? memchr(p, *(unsigned char const *)&v, n) : 0;
+				return q ? (T const *)q - p : npos;
+			}
+			for (size_t i = 0; i < n; i++) {
+				if (p[i] == v) {
+					return i;
+				}
+			}
+			return npos;
+		}
+
+		// functors for transform
+		template <typename T> struct scale {
+			T factor;
+			scale(T factor)
+				: factor(factor)
+			{
+			}
+			T operator () (T v) const
+			{
+				return v * factor;
+			}
+		};
+		template <typename T> struct clamp {
+			T lo;
+			T hi;
+			clamp(T lo, T hi)
+				: lo(lo)
+				, hi(hi)
+			{
+			}
+			T operator () (T v) const
+			{
+				return v < lo ? lo : (hi < v ? hi : v);
+			}
+		};
+
+		template <typename T, typename S> typename accum<T>::type accumulate(vector<T, S> const &v)
+		{
+			return accumulate(detail::data_of(v), v.size());
+		}
+		template <typename T, typename S, typename A> A accumulate(vector<T, S> const &v, A init)
+		{
+			return accumulate(detail::data_of(v), v.size(), init);
+		}
+		// uses the shorter length if the sizes differ
+		template <typename T, typename S> typename accum<T>::type dot(vector<T, S> const &a, vector<T, S> const &b)
+		{
+			size_t n = a.size() < b.size() ? a.size() : b.size();
+			return dot(detail::data_of(a), detail::data_of(b), n);
+		}
+		template <typename T, typename S> bool minmax(vector<T, S> const &v, T *lo, T *hi)
+		{
+			return minmax(detail::data_of(v), v.size(), lo, hi);
+		}
+		// in place
+		template <typename T, typename S, typename Op> void transform(vector<T, S> &v, Op op)
+		{
+			transform(detail::data_of(v), detail::data_of((vector<T, S> const &)v), v.size(), op);
+		}
+		template <typename T, typename S> void fill(vector<T, S> &v, T const &x)
+		{
+			fill(detail::data_of(v), v.size(), x);
+		}
+		template <typename T, typename S> size_t count(vector<T, S> const &v, T const &x)
+		{
+			return count(detail::data_of(v), v.size(), x);
+		}
+		template <typename T, typename S> size_t find(vector<T, S> const &v, T const &x)
+		{
+			return find(detail::data_of(v), v.size(), x);
+		}
+	}
+
+} // namespace tiny
+
+#endif
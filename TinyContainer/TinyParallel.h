@@ -0,0 +1,376 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyParallel_h_
+#define TinyParallel_h_
+
+#include "TinyAlgorithm.h"
+
+#if !defined(ARDUINO) && __cplusplus >= 201103L && (defined(__unix__) || defined(__APPLE__) || defined(_WIN32))
+#define TINY_HAVE_THREADS 1
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+#endif
+
+namespace tiny {
+
+	// Parallel versions of for_each, transform, reduce and sort over
+	// vectors. On hosted builds the work is split across a thread pool;
+	// elsewhere (Arduino) there is no pool and the same calls run serially,
+	// so code using them builds everywhere.
+	namespace par {
+
+		enum {
+			MIN_GRAIN = 4096, // ranges smaller than this are not split
+		};
+
+#ifdef TINY_HAVE_THREADS
+		// Work stealing pool. Each worker pushes and pops its own queue at
+		// the back and steals from the front of the others; threads that are
+		// not workers submit to a shared queue. A thread waiting for a
+		// task_group runs queued tasks instead of blocking, so tasks may
+		// fork and join further tasks.
+		class thread_pool {
+		private:
+			struct queue_t {
+				std::mutex mutex;
+				std::deque<std::function<void ()> > tasks;
+			};
+			size_t nthreads;
+			std::thread *threads;
+			queue_t *queues; // one per worker, plus the shared one at [nthreads]
+			std::atomic<long> pending;
+			bool stopping;
+			std::mutex idle_mutex;
+			std::condition_variable idle;
+
+			static thread_pool *&current_pool()
+			{
+				static thread_local thread_pool *p = 0;
+				return p;
+			}
+			static size_t &current_index()
+			{
+				static thread_local size_t i = 0;
+				return i;
+			}
+			size_t self() const
+			{
+				return current_pool() == this ? current_index() : nthreads;
+			}
+			bool take(size_t i, bool back, std::function<void ()> *out)
+			{
+				std::lock_guard<std::mutex> lock(queues[i].mutex);
+				std::deque<std::function<void ()> > &q = queues[i].tasks;
+				if (q.empty()) {
+					return false;
+				}
+				if (back) {
+					*out = std::move(q.back());
+					q.pop_back();
+				} else {
+					*out = std::move(q.front());
+					q.pop_front();
+				}
+				pending--;
+				return true;
+			}
+			bool run_one(size_t me)
+			{
+				std::function<void ()> f;
+				bool found = take(me, true, &f);
+				for (size_t k = 1; !found && k <= nthreads; k++) {
+					found = take((me + k) % (nthreads + 1), false, &f);
+				}
+				if (found) {
+					f();
+				}
+				return found;
+			}
+			void worker(size_t i)
+			{
+				current_pool() = this;
+				current_index() = i;
+				while (1) {
+					if (run_one(i)) {
+						continue;
+					}
+					std::unique_lock<std::mutex> lock(idle_mutex);
+					idle.wait(lock, [this]{ return stopping || pending > 0; });
+					if (stopping && pending <= 0) {
+						return;
+					}
+				}
+			}
+			thread_pool(thread_pool const &);
+			void operator = (thread_pool const &);
+		public:
+			// 0 means one thread per hardware thread
+			explicit thread_pool(size_t n = 0)
+				: nthreads(n ? n : (std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1))
+				, pending(0)
+				, stopping(false)
+			{
+				queues = new queue_t [nthreads + 1];
+				threads = new std::thread [nthreads];
+				for (size_t i = 0; i < nthreads; i++) {
+					threads[i] = std::thread(&thread_pool::worker, this, i);
+				}
+			}
+			~thread_pool()
+			{
+				{
+					std::lock_guard<std::mutex> lock(idle_mutex);
+					stopping = true;
+				}
+				idle.notify_all();
+				for (size_t i = 0; i < nthreads; i++) {
+					threads[i].join();
+				}
+				delete[] threads;
+				delete[] queues;
+			}
+			size_t size() const
+			{
+				return nthreads;
+			}
+			void submit(std::function<void ()> f)
+			{
+				size_t i = self();
+				{
+					std::lock_guard<std::mutex> lock(queues[i].mutex);
+					queues[i].tasks.push_back(std::move(f));
+				}
+				{
+					std::lock_guard<std::mutex> lock(idle_mutex);
+					pending++;
+				}
+				idle.notify_one();
+			}
+			// runs one queued task on the calling thread, if there is one
+			bool help()
+			{
+				return run_one(self());
+			}
+		};
+
+		// the pool used by the overloads that don't take one
+		inline thread_pool &default_pool()
+		{
+			static thread_pool pool;
+			return pool;
+		}
+
+		class task_group {
+		private:
+			thread_pool &pool;
+			std::atomic<long> left;
+			task_group(task_group const &);
+			void operator = (task_group const &);
+		public:
+			explicit task_group(thread_pool &pool)
+				: pool(pool)
+				, left(0)
+			{
+			}
+			~task_group()
+			{
+				wait();
+			}
+			template <typename F> void run(F f)
+			{
+				left++;
+				pool.submit([this, f]{
+					f();
+					left--;
+				});
+			}
+			void wait()
+			{
+				while (left > 0) {
+					if (!pool.help()) {
+						std::this_thread::yield();
+					}
+				}
+			}
+		};
+#else
+		// Serial stand-ins, so that the algorithms below have one body.
+		class thread_pool {
+		public:
+			explicit thread_pool(size_t = 0)
+			{
+			}
+			size_t size() const
+			{
+				return 1;
+			}
+		};
+
+		inline thread_pool &default_pool()
+		{
+			static thread_pool pool;
+			return pool;
+		}
+
+		class task_group {
+		public:
+			explicit task_group(thread_pool &)
+			{
+			}
+			template <typename F> void run(F f)
+			{
+				f();
+			}
+			void wait()
+			{
+			}
+		};
+#endif
+
+		namespace detail {
+			inline size_t grain(thread_pool &pool, size_t n)
+			{
+				size_t g = n / (pool.size() * 4);
+				return g < (size_t)MIN_GRAIN ? (size_t)MIN_GRAIN : g;
+			}
+
+			// calls f(begin, end) for consecutive chunks of [0, n)
+			template <typename F> void for_chunks(thread_pool &pool, size_t n, F f)
+			{
+				size_t g = grain(pool, n);
+				task_group group(pool);
+				size_t i = 0;
+				for (; i + g < n; i += g) {
+					group.run([f, i, g]{ f(i, i + g); });
+				}
+				if (i < n) {
+					f(i, n);
+				}
+				group.wait();
+			}
+
+			template <typename T, typename Compare> void sort(task_group &group, T *first, T *last, size_t depth, size_t g, Compare comp)
+			{
+				while ((size_t)(last - first) > g && depth > 0) {
+					depth--;
+					T *cut = tiny::detail::partition_pivot(first, last, comp);
+					T *l = cut;
+					group.run([&group, l, last, depth, g, comp]{ sort(group, l, last, depth, g, comp); });
+					last = cut;
+				}
+				tiny::detail::introsort(first, last, comp);
+			}
+		}
+
+		template <typename T, typename S, typename F> void for_each(thread_pool &pool, vector<T, S> &v, F f)
+		{
+			if (v.empty()) return;
+			T *p = &v[0];
+			detail::for_chunks(pool, v.size(), [p, f](size_t b, size_t e){
+				F g(f);
+				for (size_t i = b; i < e; i++) {
+					g(p[i]);
+				}
+			});
+		}
+		template <typename T, typename S, typename F> void for_each(vector<T, S> &v, F f)
+		{
+			for_each(default_pool(), v, f);
+		}
+
+		// in place: v[i] = op(v[i])
+		template <typename T, typename S, typename Op> void transform(thread_pool &pool, vector<T, S> &v, Op op)
+		{
+			for_each(pool, v, [op](T &x){ x = op(x); });
+		}
+		template <typename T, typename S, typename Op> void transform(vector<T, S> &v, Op op)
+		{
+			transform(default_pool(), v, op);
+		}
+		// dst is resized to src.size(): dst[i] = op(src[i])
+		template <typename T, typename S, typename U, typename S2, typename Op> void transform(thread_pool &pool, vector<T, S> const &src, vector<U, S2> &dst, Op op)
+		{
+			dst.resize(src.size());
+			if (src.empty() || dst.size() != src.size()) return;
+			T const *s = &src[0];
+			U *d = &dst[0];
+			detail::for_chunks(pool, src.size(), [s, d, op](size_t b, size_t e){
+				for (size_t i = b; i < e; i++) {
+					d[i] = op(s[i]);
+				}
+			});
+		}
+		template <typename T, typename S, typename U, typename S2, typename Op> void transform(vector<T, S> const &src, vector<U, S2> &dst, Op op)
+		{
+			transform(default_pool(), src, dst, op);
+		}
+
+		// op must be associative. Chunks are combined in order, so op need
+		// not be commutative. R is the type of init and of the result; each
+		// chunk starts from R(first element) and folds in the rest with op.
+		template <typename T, typename S, typename R, typename Op> R reduce(thread_pool &pool, vector<T, S> const &v, R init, Op op)
+		{
+			size_t n = v.size();
+			if (n == 0) return init;
+			size_t g = detail::grain(pool, n);
+			size_t chunks = (n + g - 1) / g;
+			vector<R> partial(chunks, R());
+			if (partial.size() != chunks) {
+				// no memory for the partial results
+				for (size_t i = 0; i < n; i++) {
+					init = op(init, v[i]);
+				}
+				return init;
+			}
+			T const *p = &v[0];
+			R *out = &partial[0];
+			detail::for_chunks(pool, n, [p, out, g, op](size_t b, size_t e){
+				R acc = R(p[b]);
+				for (size_t i = b + 1; i < e; i++) {
+					acc = op(acc, p[i]);
+				}
+				out[b / g] = acc;
+			});
+			for (size_t i = 0; i < chunks; i++) {
+				init = op(init, out[i]);
+			}
+			return init;
+		}
+		template <typename T, typename S, typename R, typename Op> R reduce(vector<T, S> const &v, R init, Op op)
+		{
+			return reduce(default_pool(), v, init, op);
+		}
+		template <typename T, typename S, typename R> R reduce(vector<T, S> const &v, R init)
+		{
+			return reduce(default_pool(), v, init, [](R const &a, R const &b){ return a + b; });
+		}
+
+		// not stable, like tiny::sort. Partitions are handed out as tasks
+		// until they are down to the grain size, then sorted serially.
+		template <typename T, typename S, typename Compare> void sort(thread_pool &pool, vector<T, S> &v, Compare comp)
+		{
+			size_t n = v.size();
+			if (n < 2) return;
+			T *p = &v[0];
+			task_group group(pool);
+			detail::sort(group, p, p + n, tiny::detail::depth_limit(n), detail::grain(pool, n), comp);
+			group.wait();
+		}
+		template <typename T, typename S, typename Compare> void sort(vector<T, S> &v, Compare comp)
+		{
+			sort(default_pool(), v, comp);
+		}
+		template <typename T, typename S> void sort(vector<T, S> &v)
+		{
+			sort(default_pool(), v, less());
+		}
+	}
+
+} // namespace tiny
+
+#endif
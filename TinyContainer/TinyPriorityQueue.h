@@ -0,0 +1,205 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyPriorityQueue_h_
+#define TinyPriorityQueue_h_
+
+#include "TinyAlgorithm.h"
+
+namespace tiny {
+
+	// Binary heap on a vector. Like std::priority_queue, top() is the
+	// greatest element under Compare; use tiny::greater to get the
+	// earliest deadline first.
+	// push() returns a handle that stays valid until the element is popped
+	// or removed, and can be used to change its key in O(log n).
+	template <typename T, typename Compare = less> class priority_queue {
+	public:
+		typedef size_t handle_t;
+		static const handle_t npos = (handle_t)-1; // push() out of memory
+	private:
+		struct entry_t {
+			T val;
+			handle_t handle;
+			entry_t(T const &v, handle_t h)
+				: val(v)
+				, handle(h)
+			{
+			}
+		};
+		vector<entry_t> heap;
+		vector<size_t> index; // handle -> heap position, or the next free handle
+		size_t free_handle;
+		Compare comp;
+		void place(size_t i, entry_t const &e)
+		{
+			heap[i] = e;
+			index[e.handle] = i;
+		}
+		void sift_up(size_t i)
+		{
+			entry_t e(heap[i]);
+			while (i > 0) {
+				size_t p = (i - 1) / 2;
+				if (!comp(heap[p].val, e.val)) break;
+				place(i, heap[p]);
+				i = p;
+			}
+			place(i, e);
+		}
+		void sift_down(size_t i)
+		{
+			entry_t e(heap[i]);
+			size_t n = heap.size();
+			while (1) {
+				size_t c = i * 2 + 1;
+				if (c >= n) break;
+				if (c + 1 < n && comp(heap[c].val, heap[c + 1].val)) c++;
+				if (!comp(e.val, heap[c].val)) break;
+				place(i, heap[c]);
+				i = c;
+			}
+			place(i, e);
+		}
+		// npos if out of memory
+		handle_t new_handle(size_t pos)
+		{
+			if (free_handle != npos) {
+				handle_t h = free_handle;
+				free_handle = index[h];
+				index[h] = pos;
+				return h;
+			}
+			if (!index.try_push_back(pos)) {
+				return npos;
+			}
+			return index.size() - 1;
+		}
+		void release_handle(handle_t h)
+		{
+			index[h] = free_handle;
+			free_handle = h;
+		}
+	public:
+		priority_queue(Compare const &comp = Compare())
+			: free_handle(npos)
+			, comp(comp)
+		{
+		}
+		size_t size() const
+		{
+			return heap.size();
+		}
+		bool empty() const
+		{
+			return heap.empty();
+		}
+		void reserve(size_t n)
+		{
+			heap.reserve(n);
+			index.reserve(n);
+		}
+		void clear()
+		{
+			heap.clear();
+			index.clear();
+			free_handle = npos;
+		}
+		T const &top() const
+		{
+			return heap[0].val;
+		}
+		handle_t top_handle() const
+		{
+			return heap[0].handle;
+		}
+		T const &get(handle_t h) const
+		{
+			return heap[index[h]].val;
+		}
+		// false, leaving the queue as it was, if memory runs out
+		bool try_push(T const &v, handle_t *handle = 0)
+		{
+			size_t i = heap.size();
+			if (!heap.try_push_back(entry_t(v, npos))) {
+				return false;
+			}
+			handle_t h = new_handle(i);
+			if (h == npos) {
+				heap.pop_back();
+				return false;
+			}
+			heap[i].handle = h;
+			sift_up(i);
+			if (handle) {
+				*handle = h;
+			}
+			return true;
+		}
+		// npos if memory runs out
+		handle_t push(T const &v)
+		{
+			handle_t h = npos;
+			try_push(v, &h);
+			return h;
+		}
+		void pop()
+		{
+			if (!heap.empty()) {
+				remove(heap[0].handle);
+			}
+		}
+		void remove(handle_t h)
+		{
+			size_t i = index[h];
+			size_t last = heap.size() - 1;
+			release_handle(h);
+			if (i != last) {
+				place(i, heap[last]);
+				heap.pop_back();
+				if (i > 0 && comp(heap[(i - 1) / 2].val, heap[i].val)) {
+					sift_up(i);
+				} else {
+					sift_down(i);
+				}
+			} else {
+				heap.pop_back();
+			}
+		}
+		// changes the key of an element in either direction, which covers
+		// both decrease-key and increase-key
+		void update(handle_t h, T const &v)
+		{
+			size_t i = index[h];
+			bool up = comp(heap[i].val, v);
+			heap[i].val = v;
+			if (up) {
+				sift_up(i);
+			} else {
+				sift_down(i);
+			}
+		}
+		// replaces the contents with the elements of vec in O(n).
+		// the element vec[i] gets the handle i. false, leaving the queue
+		// empty, if memory runs out.
+		template <typename S> bool heapify(vector<T, S> const &vec)
+		{
+			clear();
+			size_t n = vec.size();
+			if (!heap.try_reserve(n) || !index.try_reserve(n)) {
+				return false;
+			}
+			for (size_t i = 0; i < n; i++) {
+				heap.push_back(entry_t(vec[i], i));
+				index.push_back(i);
+			}
+			for (size_t i = n / 2; i > 0; i--) {
+				sift_down(i - 1);
+			}
+			return true;
+		}
+	};
+
+} // namespace tiny
+
+#endif
@@ -0,0 +1,311 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinySerialize_h_
+#define TinySerialize_h_
+
+#include "TinyView.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINY_HAVE_MMAP 1
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace tiny {
+
+	inline uint32_t adler32(void const *data, size_t len, uint32_t adler = 1)
+	{
+		unsigned char const *p = (unsigned char const *)data;
+		uint32_t a = adler & 0xffff;
+		uint32_t b = adler >> 16;
+		while (len > 0) {
+			size_t n = len < 5552 ? len : 5552; // largest n for which b cannot overflow
+			len -= n;
+			while (n-- > 0) {
+				a += *p++;
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	// Image layout, all in native byte order:
+	//
+	//   header   magic, version, header size, payload size, adler32 of payload
+	//   records  uint32 element count, zero padding up to the alignment of
+	//            the element type, then the elements. strings get a
+	//            terminating NUL that is not counted.
+	//
+	// Offsets are aligned relative to the start of the image, so the image
+	// itself must be placed at an address aligned to 8 for views into it to
+	// be aligned (mmap and heap blocks are).
+	namespace serial {
+		enum {
+			MAGIC = 0x434e5954, // "TYNC" when read on a little endian machine
+			VERSION = 1,
+			HEADER_SIZE = 16,
+		};
+		struct header_t {
+			uint32_t magic;
+			uint16_t version;
+			uint16_t header_size;
+			uint32_t payload_size;
+			uint32_t checksum;
+		};
+	}
+
+	class serializer {
+	private:
+		vector<char> buf;
+		void put(void const *p, size_t n)
+		{
+			if (n > 0) {
+				char const *c = (char const *)p;
+				buf.insert(buf.end(), c, c + n);
+			}
+		}
+		void align(size_t a)
+		{
+			static char const zeros[16] = { 0 };
+			size_t n = (a - buf.size() % a) % a;
+			while (n > 0) {
+				size_t m = n < sizeof(zeros) ? n : sizeof(zeros);
+				put(zeros, m);
+				n -= m;
+			}
+		}
+		template <typename T> void put_record(T const *p, size_t n, bool terminate)
+		{
+			static_assert(is_trivially_copyable<T>::value, "only trivially copyable types can be serialized");
+			align(sizeof(uint32_t));
+			uint32_t count = (uint32_t)n;
+			put(&count, sizeof(count));
+			align(alignof(T));
+			put(p, sizeof(T) * n);
+			if (terminate) {
+				T z = T();
+				put(&z, sizeof(T));
+			}
+		}
+	public:
+		serializer()
+		{
+			clear();
+		}
+		void clear()
+		{
+			buf.clear();
+			serial::header_t h;
+			memset(&h, 0, sizeof(h));
+			put(&h, sizeof(h));
+		}
+		void reserve(size_t n)
+		{
+			buf.reserve(serial::HEADER_SIZE + n);
+		}
+		template <typename T> void write_value(T const &v)
+		{
+			static_assert(is_trivially_copyable<T>::value, "only trivially copyable types can be serialized");
+			align(alignof(T));
+			put(&v, sizeof(T));
+		}
+		template <typename T> void write_array(T const *p, size_t n)
+		{
+			put_record(p, n, false);
+		}
+		template <typename T, typename S> void write(vector<T, S> const &v)
+		{
+			put_record(v.empty() ? (T const *)0 : &v[0], v.size(), false);
+		}
+		template <typename T> void write(t_stringbuffer<T> const &s)
+		{
+			put_record(s.c_str(), s.size(), true);
+		}
+		template <typename T> void write(basic_string_view<T> const &s)
+		{
+			put_record(s.data(), s.size(), true);
+		}
+		// fills in the header. data() and size() are the finished image.
+		void finish()
+		{
+			serial::header_t h;
+			h.magic = serial::MAGIC;
+			h.version = serial::VERSION;
+			h.header_size = serial::HEADER_SIZE;
+			h.payload_size = (uint32_t)(buf.size() - serial::HEADER_SIZE);
+			h.checksum = adler32(&buf[0] + serial::HEADER_SIZE, h.payload_size);
+			memcpy(&buf[0], &h, sizeof(h));
+		}
+		char const *data() const
+		{
+			return &buf[0];
+		}
+		size_t size() const
+		{
+			return buf.size();
+		}
+#ifdef TINY_HAVE_MMAP
+		bool save(char const *path) const
+		{
+			FILE *fp = fopen(path, "wb");
+			if (!fp) return false;
+			bool ok = fwrite(data(), 1, size(), fp) == size();
+			return fclose(fp) == 0 && ok;
+		}
+#endif
+	};
+
+	// Reads an image in place. Values are copied out, but vectors and
+	// strings come back as views pointing straight into the image.
+	class deserializer {
+	private:
+		char const *base;
+		size_t limit;
+		size_t pos;
+		bool ok;
+		bool align(size_t a)
+		{
+			pos += (a - pos % a) % a;
+			return pos <= limit;
+		}
+		template <typename T> bool get_record(T const **p, size_t *n, bool terminated)
+		{
+			uint32_t count;
+			if (!ok || !align(sizeof(uint32_t)) || limit - pos < sizeof(count)) return ok = false;
+			memcpy(&count, base + pos, sizeof(count));
+			pos += sizeof(count);
+			if (!align(alignof(T))) return ok = false;
+			// count and the terminator must fit a size_t without wrapping;
+			// a corrupt count must not turn into a short record
+			size_t extra = terminated ? 1 : 0;
+			if (count > (size_t)-1 - extra) return ok = false;
+			size_t len = (size_t)count + extra;
+			if ((limit - pos) / sizeof(T) < len) return ok = false;
+			if ((uintptr_t)(base + pos) % alignof(T)) return ok = false;
+			*p = (T const *)(base + pos);
+			*n = count;
+			pos += sizeof(T) * len;
+			return true;
+		}
+	public:
+		deserializer(void const *data, size_t size, bool verify = true)
+			: base((char const *)data)
+			, limit(0)
+			, pos(serial::HEADER_SIZE)
+			, ok(false)
+		{
+			serial::header_t h;
+			if (!data || size < sizeof(h)) return;
+			memcpy(&h, data, sizeof(h));
+			if (h.magic != serial::MAGIC || h.version != serial::VERSION || h.header_size != serial::HEADER_SIZE) return;
+			if (h.payload_size > size - serial::HEADER_SIZE) return;
+			if (verify && adler32(base + serial::HEADER_SIZE, h.payload_size) != h.checksum) return;
+			limit = serial::HEADER_SIZE + h.payload_size;
+			ok = true;
+		}
+		// false if the header or checksum was bad, or a read ran past the end
+		bool valid() const
+		{
+			return ok;
+		}
+		bool at_end() const
+		{
+			return pos >= limit;
+		}
+		template <typename T> bool read_value(T *out)
+		{
+			if (!ok || !align(alignof(T)) || limit - pos < sizeof(T)) return ok = false;
+			memcpy((void *)out, base + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+		template <typename T> bool read(vector_view<T> *out)
+		{
+			T const *p;
+			size_t n;
+			if (!get_record(&p, &n, false)) return false;
+			*out = vector_view<T>(p, n);
+			return true;
+		}
+		template <typename T> bool read(basic_string_view<T> *out)
+		{
+			T const *p;
+			size_t n;
+			if (!get_record(&p, &n, true)) return false;
+			*out = basic_string_view<T>(p, n);
+			return true;
+		}
+	};
+
+#ifdef TINY_HAVE_MMAP
+	// Read-only memory mapping of a whole file, for handing images to deserializer.
+	class mapped_file {
+	private:
+		void *ptr;
+		size_t len;
+		mapped_file(mapped_file const &);
+		void operator = (mapped_file const &);
+	public:
+		mapped_file()
+			: ptr(0)
+			, len(0)
+		{
+		}
+		mapped_file(char const *path)
+			: ptr(0)
+			, len(0)
+		{
+			open(path);
+		}
+		~mapped_file()
+		{
+			close();
+		}
+		bool open(char const *path)
+		{
+			close();
+			int fd = ::open(path, O_RDONLY);
+			if (fd < 0) return false;
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED) {
+					ptr = p;
+					len = st.st_size;
+				}
+			}
+			::close(fd);
+			return ptr != 0;
+		}
+		void close()
+		{
+			if (ptr) {
+				munmap(ptr, len);
+				ptr = 0;
+				len = 0;
+			}
+		}
+		bool is_open() const
+		{
+			return ptr != 0;
+		}
+		void const *data() const
+		{
+			return ptr;
+		}
+		size_t size() const
+		{
+			return len;
+		}
+	};
+#endif
+
+} // namespace tiny
+
+#endif
@@ -0,0 +1,189 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinySlotMap_h_
+#define TinySlotMap_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Values are kept densely packed in a vector, so iterating over them is
+	// a plain array walk. insert() hands out a handle that stays valid until
+	// the value is erased; a handle to an erased value is detected by its
+	// generation and never aliases a newer value in the same slot.
+	// Erasing moves the last value into the hole, so the order of values is
+	// not preserved.
+	template <typename T> class slot_map {
+	public:
+		struct handle_t {
+			size_t index;
+			unsigned int generation;
+			bool operator == (handle_t const &r) const
+			{
+				return index == r.index && generation == r.generation;
+			}
+			bool operator != (handle_t const &r) const
+			{
+				return !operator == (r);
+			}
+		};
+		typedef typename vector<T>::iterator iterator;
+		typedef typename vector<T>::const_iterator const_iterator;
+	private:
+		static const size_t npos = (size_t)-1;
+		struct slot_t {
+			size_t index; // position in values if live, otherwise the next free slot
+			unsigned int generation;
+		};
+		vector<T> values;
+		vector<size_t> owners; // position in values -> slot
+		vector<slot_t> slots;
+		size_t free_slot;
+		slot_t const *lookup(handle_t h) const
+		{
+			if (h.index < slots.size()) {
+				slot_t const *s = &slots[h.index];
+				if (s->generation == h.generation) return s;
+			}
+			return 0;
+		}
+	public:
+		slot_map()
+			: free_slot(npos)
+		{
+		}
+		size_t size() const
+		{
+			return values.size();
+		}
+		bool empty() const
+		{
+			return values.empty();
+		}
+		void reserve(size_t n)
+		{
+			values.reserve(n);
+			owners.reserve(n);
+			slots.reserve(n);
+		}
+		void clear()
+		{
+			for (size_t i = 0; i < owners.size(); i++) {
+				size_t s = owners[i];
+				slots[s].generation++;
+				slots[s].index = free_slot;
+				free_slot = s;
+			}
+			values.clear();
+			owners.clear();
+		}
+		// false, leaving the map as it was, if memory runs out
+		bool try_insert(T const &v, handle_t *h)
+		{
+			size_t s = free_slot;
+			if (s == npos) {
+				slot_t t;
+				t.index = npos;
+				t.generation = 0;
+				if (!slots.try_push_back(t)) return false;
+				s = slots.size() - 1;
+			}
+			if (!values.try_push_back(v)) {
+				if (s != free_slot) slots.pop_back();
+				return false;
+			}
+			if (!owners.try_push_back(s)) {
+				values.pop_back();
+				if (s != free_slot) slots.pop_back();
+				return false;
+			}
+			if (s == free_slot) {
+				free_slot = slots[s].index;
+			}
+			slots[s].index = values.size() - 1;
+			h->index = s;
+			h->generation = slots[s].generation;
+			return true;
+		}
+		// if memory runs out, returns a handle that contains() rejects
+		handle_t insert(T const &v)
+		{
+			handle_t h;
+			if (!try_insert(v, &h)) {
+				h.index = npos;
+				h.generation = 0;
+			}
+			return h;
+		}
+		bool erase(handle_t h)
+		{
+			if (!lookup(h)) return false;
+			slot_t &slot = slots[h.index];
+			size_t i = slot.index;
+			size_t last = values.size() - 1;
+			if (i != last) {
+				values[i] = values[last];
+				owners[i] = owners[last];
+				slots[owners[i]].index = i;
+			}
+			values.pop_back();
+			owners.pop_back();
+			slot.generation++;
+			slot.index = free_slot;
+			free_slot = h.index;
+			return true;
+		}
+		bool contains(handle_t h) const
+		{
+			return lookup(h) != 0;
+		}
+		// returns null if the handle is stale
+		T *find(handle_t h)
+		{
+			slot_t const *s = lookup(h);
+			return s ? &values[s->index] : 0;
+		}
+		T const *find(handle_t h) const
+		{
+			slot_t const *s = lookup(h);
+			return s ? &values[s->index] : 0;
+		}
+		// unchecked lookup
+		T &operator [] (handle_t h)
+		{
+			return values[slots[h.index].index];
+		}
+		T const &operator [] (handle_t h) const
+		{
+			return values[slots[h.index].index];
+		}
+		// handle of the value at position i of the dense array
+		handle_t handle_at(size_t i) const
+		{
+			handle_t h;
+			h.index = owners[i];
+			h.generation = slots[h.index].generation;
+			return h;
+		}
+		iterator begin()
+		{
+			return values.begin();
+		}
+		const_iterator begin() const
+		{
+			return values.begin();
+		}
+		iterator end()
+		{
+			return values.end();
+		}
+		const_iterator end() const
+		{
+			return values.end();
+		}
+	};
+
+} // namespace tiny
+
+#endif
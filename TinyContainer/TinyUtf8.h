@@ -0,0 +1,279 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyUtf8_h_
+#define TinyUtf8_h_
+
+#include "TinyView.h"
+
+namespace tiny {
+
+	// UTF-8 over char strings and views. Invalid sequences (overlong
+	// forms, surrogates, code points past U+10FFFF, truncated or stray
+	// bytes) are rejected by validate() and decoded as U+FFFD, one byte
+	// at a time, by everything else.
+	namespace utf8 {
+		typedef uint32_t code_point;
+
+		enum {
+			REPLACEMENT = 0xfffd,
+		};
+
+		namespace detail {
+			inline uint64_t load8(unsigned char const *p)
+			{
+				uint64_t w;
+				memcpy(&w, p, 8);
+				return w;
+			}
+			inline bool ascii8(unsigned char const *p)
+			{
+				return (load8(p) & 0x8080808080808080ULL) == 0;
+			}
+			inline bool cont(unsigned char c)
+			{
+				return (c & 0xc0) == 0x80;
+			}
+
+			// length of the valid sequence at p, storing its code point, or 0
+			inline size_t decode(unsigned char const *p, size_t n, code_point *cp)
+			{
+				unsigned char c = p[0];
+				if (c < 0x80) {
+					*cp = c;
+					return 1;
+				}
+				if (c < 0xc2) return 0;
+				if (c < 0xe0) {
+					if (n < 2 || !cont(p[1])) return 0;
+					*cp = ((c & 0x1f) << 6) | (p[1] & 0x3f);
+					return 2;
+				}
+				if (c < 0xf0) {
+					if (n < 3 || !cont(p[1]) || !cont(p[2])) return 0;
+					if (c == 0xe0 && p[1] < 0xa0) return 0; // overlong
+					if (c == 0xed && p[1] > 0x9f) return 0; // surrogate
+					*cp = ((code_point)(c & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+					return 3;
+				}
+				if (c < 0xf5) {
+					if (n < 4 || !cont(p[1]) || !cont(p[2]) || !cont(p[3])) return 0;
+					if (c == 0xf0 && p[1] < 0x90) return 0; // overlong
+					if (c == 0xf4 && p[1] > 0x8f) return 0; // past U+10FFFF
+					*cp = ((code_point)(c & 0x07) << 18) | ((code_point)(p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+					return 4;
+				}
+				return 0;
+			}
+		}
+
+		inline bool validate(char const *s, size_t n)
+		{
+			unsigned char const *p = (unsigned char const *)s;
+			unsigned char const *e = p + n;
+			while (p < e) {
+				// ASCII fast path: 16, then 8 bytes at a time
+				while (e - p >= 16 && ((detail::load8(p) | detail::load8(p + 8)) & 0x8080808080808080ULL) == 0) {
+					p += 16;
+				}
+				if (e - p >= 8 && detail::ascii8(p)) {
+					p += 8;
+					continue;
+				}
+				while (p < e && *p < 0x80) {
+					p++;
+				}
+				if (p < e) {
+					code_point cp;
+					size_t k = detail::decode(p, e - p, &cp);
+					if (k == 0) return false;
+					p += k;
+				}
+			}
+			return true;
+		}
+		inline bool validate(string_view const &s)
+		{
+			return validate(s.data(), s.size());
+		}
+
+		// decodes the code point at *p and advances *p past it
+		inline code_point next(char const **p, char const *end)
+		{
+			code_point cp;
+			size_t k = detail::decode((unsigned char const *)*p, end - *p, &cp);
+			if (k == 0) {
+				*p += 1;
+				return REPLACEMENT;
+			}
+			*p += k;
+			return cp;
+		}
+
+		// number of code points
+		inline size_t length(char const *s, size_t n)
+		{
+			char const *e = s + n;
+			size_t len = 0;
+			while (s < e) {
+				next(&s, e);
+				len++;
+			}
+			return len;
+		}
+		inline size_t length(string_view const &s)
+		{
+			return length(s.data(), s.size());
+		}
+
+		// writes the encoding of cp to out, which must have room for 4 bytes.
+		// returns its length.
+		inline size_t encode(code_point cp, char *out)
+		{
+			if (cp >= 0xd800 && cp < 0xe000) cp = REPLACEMENT;
+			if (cp < 0x80) {
+				out[0] = (char)cp;
+				return 1;
+			}
+			if (cp < 0x800) {
+				out[0] = (char)(0xc0 | (cp >> 6));
+				out[1] = (char)(0x80 | (cp & 0x3f));
+				return 2;
+			}
+			if (cp < 0x10000) {
+				out[0] = (char)(0xe0 | (cp >> 12));
+				out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+				out[2] = (char)(0x80 | (cp & 0x3f));
+				return 3;
+			}
+			if (cp < 0x110000) {
+				out[0] = (char)(0xf0 | (cp >> 18));
+				out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+				out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+				out[3] = (char)(0x80 | (cp & 0x3f));
+				return 4;
+			}
+			return encode(REPLACEMENT, out);
+		}
+
+		// Converts to UTF-16, writing at most cap units to out (which may be
+		// null to only measure). Returns the number of units the whole
+		// conversion needs; nothing is terminated.
+		inline size_t to_utf16(char const *s, size_t n, char16_t *out, size_t cap)
+		{
+			unsigned char const *p = (unsigned char const *)s;
+			unsigned char const *e = p + n;
+			size_t w = 0;
+			while (p < e) {
+				bool room = w + 8 <= cap;
+				if (e - p >= 8 && (!out || room || w >= cap) && detail::ascii8(p)) {
+					if (out && room) {
+						for (int i = 0; i < 8; i++) {
+							out[w + i] = p[i];
+						}
+					}
+					w += 8;
+					p += 8;
+					continue;
+				}
+				char const *q = (char const *)p;
+				code_point cp = next(&q, (char const *)e);
+				p = (unsigned char const *)q;
+				if (cp < 0x10000) {
+					if (out && w < cap) out[w] = (char16_t)cp;
+					w++;
+				} else {
+					cp -= 0x10000;
+					if (out && w + 1 < cap) {
+						out[w] = (char16_t)(0xd800 | (cp >> 10));
+						out[w + 1] = (char16_t)(0xdc00 | (cp & 0x3ff));
+					}
+					w += 2;
+				}
+			}
+			return w;
+		}
+		inline t_stringbuffer<char16_t> to_utf16(string_view const &s)
+		{
+			t_stringbuffer<char16_t> r;
+			size_t n = to_utf16(s.data(), s.size(), 0, 0);
+			if (n > 0) {
+				vector<char16_t> buf(n, 0);
+				if (buf.size() == n) {
+					to_utf16(s.data(), s.size(), &buf[0], n);
+					r.print(&buf[0], n);
+				}
+			}
+			return r;
+		}
+
+		// iterates over the code points of a string or view
+		class iterator {
+		private:
+			char const *ptr;
+			char const *end;
+		public:
+			iterator(char const *ptr, char const *end)
+				: ptr(ptr)
+				, end(end)
+			{
+			}
+			bool operator == (iterator const &it) const
+			{
+				return ptr == it.ptr;
+			}
+			bool operator != (iterator const &it) const
+			{
+				return ptr != it.ptr;
+			}
+			code_point operator * () const
+			{
+				char const *p = ptr;
+				return next(&p, end);
+			}
+			void operator ++ ()
+			{
+				next(&ptr, end);
+			}
+			void operator ++ (int)
+			{
+				next(&ptr, end);
+			}
+			// position in the underlying bytes
+			char const *get() const
+			{
+				return ptr;
+			}
+		};
+
+		// for (code_point c : utf8::code_points(s)) ...
+		class code_points {
+		private:
+			string_view text;
+		public:
+			code_points(string_view const &text)
+				: text(text)
+			{
+			}
+			code_points(t_stringbuffer<char> const &s)
+				: text(s)
+			{
+			}
+			code_points(char const *s)
+				: text(s)
+			{
+			}
+			iterator begin() const
+			{
+				return iterator(text.begin(), text.end());
+			}
+			iterator end() const
+			{
+				return iterator(text.end(), text.end());
+			}
+		};
+	}
+
+} // namespace tiny
+
+#endif
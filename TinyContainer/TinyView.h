@@ -0,0 +1,147 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyView_h_
+#define TinyView_h_
+
+#include "TinyContainer.h"
+
+namespace tiny {
+
+	// Read-only views over memory owned by someone else: a vector, a
+	// flash image, a memory mapped file or a reused buffer. A view is only
+	// valid as long as that memory is.
+
+	template <typename T> class vector_view {
+	private:
+		T const *ptr;
+		size_t count;
+	public:
+		vector_view()
+			: ptr(0)
+			, count(0)
+		{
+		}
+		vector_view(T const *ptr, size_t count)
+			: ptr(ptr)
+			, count(count)
+		{
+		}
+		template <typename S> vector_view(vector<T, S> const &vec)
+			: ptr(vec.empty() ? 0 : &vec[0])
+			, count(vec.size())
+		{
+		}
+		size_t size() const
+		{
+			return count;
+		}
+		bool empty() const
+		{
+			return count == 0;
+		}
+		T const *data() const
+		{
+			return ptr;
+		}
+		T const *begin() const
+		{
+			return ptr;
+		}
+		T const *end() const
+		{
+			return ptr + count;
+		}
+		T const &operator [] (size_t i) const
+		{
+			return ptr[i];
+		}
+	};
+
+	template <typename T> class basic_string_view {
+	private:
+		T const *ptr;
+		size_t len;
+	public:
+		basic_string_view()
+			: ptr(zerostring<T>())
+			, len(0)
+		{
+		}
+		basic_string_view(T const *ptr)
+			: ptr(ptr)
+			, len(strlength(ptr))
+		{
+		}
+		basic_string_view(T const *ptr, size_t len)
+			: ptr(ptr)
+			, len(len)
+		{
+		}
+		// the view points into s, so s must not be modified while the view is used
+		basic_string_view(t_stringbuffer<T> const &s)
+			: ptr(s.c_str())
+			, len(s.size())
+		{
+		}
+		size_t size() const
+		{
+			return len;
+		}
+		bool empty() const
+		{
+			return len == 0;
+		}
+		T const *data() const
+		{
+			return ptr;
+		}
+		T const *begin() const
+		{
+			return ptr;
+		}
+		T const *end() const
+		{
+			return ptr + len;
+		}
+		T operator [] (size_t i) const
+		{
+			return ptr[i];
+		}
+		basic_string_view substr(size_t pos, size_t n = (size_t)-1) const
+		{
+			if (pos > len) pos = len;
+			if (n > len - pos) n = len - pos;
+			return basic_string_view(ptr + pos, n);
+		}
+		t_stringbuffer<T> str() const
+		{
+			return t_stringbuffer<T>(ptr, len);
+		}
+		int compare(basic_string_view const &r) const
+		{
+			size_t n = len < r.len ? len : r.len;
+			for (size_t i = 0; i < n; i++) {
+				if (ptr[i] != r.ptr[i]) return ptr[i] < r.ptr[i] ? -1 : 1;
+			}
+			return len < r.len ? -1 : (len > r.len ? 1 : 0);
+		}
+		bool operator == (basic_string_view const &r) const
+		{
+			return len == r.len && compare(r) == 0;
+		}
+		bool operator != (basic_string_view const &r) const
+		{
+			return !operator == (r);
+		}
+		bool operator < (basic_string_view const &r) const
+		{
+			return compare(r) < 0;
+		}
+	};
+
+	typedef basic_string_view<char> string_view;
+
+} // namespace tiny
+
+#endif
@@ -0,0 +1,352 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef TinyWriter_h_
+#define TinyWriter_h_
+
+#include "TinyView.h"
+#include <float.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#ifndef TINY_HAVE_FD
+#define TINY_HAVE_FD 1
+#endif
+#include <unistd.h>
+#endif
+
+namespace tiny {
+
+	// Sinks for writer. write(p, n) takes all n bytes. Anything with that
+	// member can be used.
+
+	// Arduino Print (Serial, a client, a file), or anything with
+	// write(uint8_t const *, size_t)
+	template <typename S> class stream_sink {
+	private:
+		S *stream;
+	public:
+		stream_sink(S &s)
+			: stream(&s)
+		{
+		}
+		void write(char const *p, size_t n)
+		{
+			stream->write((uint8_t const *)p, n);
+		}
+	};
+
+	// appends to a string
+	template <typename T> class string_sink {
+	private:
+		t_stringbuffer<T> *str;
+	public:
+		string_sink(t_stringbuffer<T> &s)
+			: str(&s)
+		{
+		}
+		void write(T const *p, size_t n)
+		{
+			str->print(p, n);
+		}
+	};
+
+#ifdef TINY_HAVE_FD
+	// POSIX file descriptor. Does not close it.
+	class fd_sink {
+	private:
+		int fd;
+	public:
+		fd_sink(int fd)
+			: fd(fd)
+		{
+		}
+		void write(char const *p, size_t n)
+		{
+			while (n > 0) {
+				ssize_t r = ::write(fd, p, n);
+				if (r <= 0) break;
+				p += r;
+				n -= r;
+			}
+		}
+	};
+#endif
+
+	// Formats into a fixed buffer and hands it to a sink whenever it fills,
+	// so output of any length is produced in the memory of the buffer. The
+	// sink is referred to, not copied, and must outlive the writer.
+	// Whatever is left in the buffer is flushed by flush() and by the
+	// destructor.
+	class writer {
+	private:
+		char *buf;
+		size_t cap;
+		size_t len;
+		void *sink;
+		void (*sink_write)(void *sink, char const *p, size_t n);
+		template <typename Sink> static void call(void *sink, char const *p, size_t n)
+		{
+			((Sink *)sink)->write(p, n);
+		}
+		writer(writer const &);
+		void operator = (writer const &);
+
+		// bytes that need no escaping in a JSON string
+		static bool json_plain(unsigned char c)
+		{
+			return c >= 0x20 && c != '"' && c != '\\';
+		}
+		static bool csv_plain(char c)
+		{
+			return c != '"' && c != ',' && c != '\r' && c != '\n';
+		}
+		void unsigned_digits(unsigned long long v)
+		{
+			char tmp[20];
+			size_t i = sizeof(tmp);
+			do {
+				tmp[--i] = (char)('0' + v % 10);
+				v /= 10;
+			} while (v > 0);
+			write(tmp + i, sizeof(tmp) - i);
+		}
+	public:
+		// buf is the scratch buffer, of cap bytes (at least 1)
+		template <typename Sink> writer(char *buf, size_t cap, Sink &sink)
+			: buf(buf)
+			, cap(cap)
+			, len(0)
+			, sink(&sink)
+			, sink_write(&call<Sink>)
+		{
+		}
+		~writer()
+		{
+			flush();
+		}
+		void flush()
+		{
+			if (len > 0) {
+				sink_write(sink, buf, len);
+				len = 0;
+			}
+		}
+		void put(char c)
+		{
+			if (len == cap) {
+				flush();
+			}
+			buf[len++] = c;
+		}
+		void write(char const *p, size_t n)
+		{
+			if (n > cap - len) {
+				flush();
+				if (n >= cap) {
+					// too large to be worth copying
+					sink_write(sink, p, n);
+					return;
+				}
+			}
+			memcpy(buf + len, p, n);
+			len += n;
+		}
+		// the character, not its code
+		void print(char c)
+		{
+			put(c);
+		}
+		void print(char const *s)
+		{
+			write(s, strlen(s));
+		}
+		void print(string_view const &s)
+		{
+			write(s.data(), s.size());
+		}
+		void print(unsigned long long v)
+		{
+			unsigned_digits(v);
+		}
+		void print(long long v)
+		{
+			if (v < 0) {
+				put('-');
+				unsigned_digits(0 - (unsigned long long)v);
+			} else {
+				unsigned_digits(v);
+			}
+		}
+		void print(unsigned long v)
+		{
+			unsigned_digits(v);
+		}
+		void print(long v)
+		{
+			print((long long)v);
+		}
+		void print(unsigned int v)
+		{
+			unsigned_digits(v);
+		}
+		void print(int v)
+		{
+			print((long long)v);
+		}
+		// fixed point with the given number of decimals, at most 19,
+		// rounded. Beyond 1.8e19 the digits past the 18th print as zeros.
+		void print(double v, unsigned decimals = 2)
+		{
+			if (decimals > 19) {
+				// 10^19 is the largest power of ten an unsigned long long holds
+				decimals = 19;
+			}
+			if (v != v) {
+				print("nan");
+				return;
+			}
+			if (v < 0) {
+				put('-');
+				v = -v;
+			}
+			if (v > DBL_MAX) {
+				print("inf");
+				return;
+			}
+			if (v >= 1.8e19) {
+				// past an unsigned long long: the leading 18 digits, then zeros.
+				// there is no fraction at this size.
+				unsigned zeros = 0;
+				while (v >= 1e18) {
+					v /= 10;
+					zeros++;
+				}
+				unsigned_digits((unsigned long long)(v + 0.5));
+				for (unsigned i = 0; i < zeros; i++) {
+					put('0');
+				}
+				if (decimals > 0) {
+					put('.');
+					for (unsigned i = 0; i < decimals; i++) {
+						put('0');
+					}
+				}
+				return;
+			}
+			double scale = 1;
+			for (unsigned i = 0; i < decimals; i++) {
+				scale *= 10;
+			}
+			unsigned long long whole = (unsigned long long)v;
+			unsigned long long frac = (unsigned long long)((v - whole) * scale + 0.5);
+			if (frac >= scale) {
+				whole++;
+				frac -= (unsigned long long)scale;
+			}
+			unsigned_digits(whole);
+			if (decimals > 0) {
+				put('.');
+				char tmp[19];
+				for (unsigned i = decimals; i > 0; i--) {
+					tmp[i - 1] = (char)('0' + frac % 10);
+					frac /= 10;
+				}
+				write(tmp, decimals);
+			}
+		}
+
+		// the contents of a JSON string, escaped but without the quotes.
+		// runs that need no escaping are copied in one go.
+		void json_escape(char const *s, size_t n)
+		{
+			static const char hex[] = "0123456789abcdef";
+			char const *e = s + n;
+			while (s < e) {
+				char const *p = s;
+				while (p < e && json_plain(*p)) {
+					p++;
+				}
+				write(s, p - s);
+				if (p == e) break;
+				unsigned char c = *p++;
+				put('\\');
+				switch (c) {
+				case '"':  put('"'); break;
+				case '\\': put('\\'); break;
+				case '\b': put('b'); break;
+				case '\f': put('f'); break;
+				case '\n': put('n'); break;
+				case '\r': put('r'); break;
+				case '\t': put('t'); break;
+				default:
+					write("u00", 3);
+					put(hex[c >> 4]);
+					put(hex[c & 15]);
+					break;
+				}
+				s = p;
+			}
+		}
+		void json_escape(string_view const &s)
+		{
+			json_escape(s.data(), s.size());
+		}
+		// a quoted JSON string
+		void json_string(string_view const &s)
+		{
+			put('"');
+			json_escape(s.data(), s.size());
+			put('"');
+		}
+
+		// a CSV field (RFC 4180): written as is, unless it contains a
+		// quote, comma or line break, in which case it is quoted and its
+		// quotes are doubled
+		void csv_field(char const *s, size_t n)
+		{
+			char const *e = s + n;
+			char const *p = s;
+			while (p < e && csv_plain(*p)) {
+				p++;
+			}
+			if (p == e) {
+				write(s, n);
+				return;
+			}
+			put('"');
+			while (s < e) {
+				p = (char const *)memchr(s, '"', e - s);
+				if (!p) {
+					write(s, e - s);
+					break;
+				}
+				write(s, p + 1 - s);
+				put('"');
+				s = p + 1;
+			}
+			put('"');
+		}
+		void csv_field(string_view const &s)
+		{
+			csv_field(s.data(), s.size());
+		}
+	};
+
+	// a writer with its own buffer of N bytes
+	template <size_t N> class fixed_writer : public writer {
+	private:
+		char storage[N];
+	public:
+		template <typename Sink> fixed_writer(Sink &sink)
+			: writer(storage, N, sink)
+		{
+		}
+		~fixed_writer()
+		{
+			flush();
+		}
+	};
+
+} // namespace tiny
+
+#endif
@@ -0,0 +1,142 @@
+// Tiny Container Template Library for Arduino
+// Copyright (C) 2015 S.Fuchita (@soramimi_jp)
+
+#ifndef bench_h_
+#define bench_h_
+
+// Helpers shared by the host benchmarks and tests: a clock, an
+// instruction counter where the kernel offers one, and result checks.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAVE_PERF 1
+#endif
+
+namespace bench {
+
+	// "quick" as the first argument asks for small inputs, as under ctest
+	inline bool quick(int argc, char **argv)
+	{
+		return argc > 1 && strcmp(argv[1], "quick") == 0;
+	}
+
+	inline double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// keeps the compiler from dropping a computed value
+	template <typename T> inline void keep(T const &v)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "g"(&v) : "memory");
+#else
+		static volatile T const *sink;
+		sink = &v;
+#endif
+	}
+
+	// best of reps runs of f, in seconds
+	template <typename F> double best(int reps, F f)
+	{
+		double t = 1e30;
+		for (int i = 0; i < reps; i++) {
+			double s = now();
+			f();
+			double e = now() - s;
+			if (e < t) t = e;
+		}
+		return t;
+	}
+
+	inline void report(char const *name, double seconds, size_t n)
+	{
+		printf("%-44s %12.3f ms %10.2f ns/elem\n", name, seconds * 1e3, n ? seconds * 1e9 / n : 0.0);
+	}
+
+	inline int &failures()
+	{
+		static int n = 0;
+		return n;
+	}
+
+	inline void check(bool ok, char const *what)
+	{
+		if (!ok) {
+			printf("FAILED: %s\n", what);
+			failures()++;
+		}
+	}
+
+	// user space instructions retired by the calling thread. available()
+	// is false where perf events are not permitted, as in most containers.
+	class instruction_counter {
+	private:
+		int fd;
+		instruction_counter(instruction_counter const &);
+		void operator = (instruction_counter const &);
+	public:
+		instruction_counter()
+			: fd(-1)
+		{
+#ifdef BENCH_HAVE_PERF
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+		}
+		~instruction_counter()
+		{
+#ifdef BENCH_HAVE_PERF
+			if (fd >= 0) close(fd);
+#endif
+		}
+		bool available() const
+		{
+			return fd >= 0;
+		}
+		template <typename F> uint64_t count(F f)
+		{
+			uint64_t n = 0;
+#ifdef BENCH_HAVE_PERF
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+				f();
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(fd, &n, sizeof(n)) != (ssize_t)sizeof(n)) {
+					n = 0;
+				}
+				return n;
+			}
+#endif
+			f();
+			return n;
+		}
+	};
+
+	inline int finish()
+	{
+		if (failures()) {
+			printf("%d check(s) failed\n", failures());
+			return 1;
+		}
+		return 0;
+	}
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Release iterator loops against the same loops over raw pointers. The
+// iterators carry no checks without TINY_CHECKED, so both should run the
+// same instructions; where perf events are available that is checked.
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include <stdlib.h>
+
+using namespace tiny;
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE static long sum_iterator(vector<int> const &v)
+{
+	long s = 0;
+	for (vector<int>::const_iterator it = v.begin(); it != v.end(); it++) {
+		s += *it;
+	}
+	return s;
+}
+
+BENCH_NOINLINE static long sum_pointer(int const *p, size_t n)
+{
+	long s = 0;
+	for (int const *e = p + n; p != e; p++) {
+		s += *p;
+	}
+	return s;
+}
+
+BENCH_NOINLINE static long sum_index(vector<int> const &v)
+{
+	long s = 0;
+	for (size_t i = 0; i < v.size(); i++) {
+		s += v[i];
+	}
+	return s;
+}
+
+BENCH_NOINLINE static long sum_reverse(vector<int> const &v)
+{
+	long s = 0;
+	for (vector<int>::const_reverse_iterator it = v.rbegin(); it != v.rend(); it++) {
+		s += *it;
+	}
+	return s;
+}
+
+BENCH_NOINLINE static void scale_iterator(vector<int> &v)
+{
+	for (vector<int>::iterator it = v.begin(); it != v.end(); it++) {
+		*it *= 3;
+	}
+}
+
+BENCH_NOINLINE static void scale_pointer(int *p, size_t n)
+{
+	for (int *e = p + n; p != e; p++) {
+		*p *= 3;
+	}
+}
+
+// the iterator loop may run a few more instructions around the loop, but
+// not per element
+static void compare(bench::instruction_counter &ic, char const *name, uint64_t it, uint64_t raw, size_t n)
+{
+	if (!ic.available()) {
+		return;
+	}
+	printf("%-44s %12llu / %llu instructions\n", name, (unsigned long long)it, (unsigned long long)raw);
+	bench::check(it <= raw + raw / 100 + n / 1000 + 100, name);
+}
+
+int main(int argc, char **argv)
+{
+	size_t n = bench::quick(argc, argv) ? 100000 : 10000000;
+	int reps = bench::quick(argc, argv) ? 3 : 10;
+	vector<int> v(n, 0);
+	srand(1);
+	for (size_t i = 0; i < n; i++) {
+		v[i] = rand() % 1000;
+	}
+	bench::instruction_counter ic;
+	if (!ic.available()) {
+		printf("instruction counts not available, timing only\n");
+	}
+
+	long s1 = 0, s2 = 0;
+	double t;
+	t = bench::best(reps, [&]{ s1 = sum_iterator(v); });
+	bench::report("sum, const_iterator", t, n);
+	t = bench::best(reps, [&]{ s2 = sum_pointer(&v[0], n); });
+	bench::report("sum, raw pointer", t, n);
+	bench::check(s1 == s2, "sum, const_iterator");
+	compare(ic, "sum, const_iterator vs raw pointer", ic.count([&]{ s1 = sum_iterator(v); }), ic.count([&]{ s2 = sum_pointer(&v[0], n); }), n);
+
+	t = bench::best(reps, [&]{ s1 = sum_index(v); });
+	bench::report("sum, operator []", t, n);
+	bench::check(s1 == s2, "sum, operator []");
+	compare(ic, "sum, operator [] vs raw pointer", ic.count([&]{ s1 = sum_index(v); }), ic.count([&]{ s2 = sum_pointer(&v[0], n); }), n);
+
+	t = bench::best(reps, [&]{ s1 = sum_reverse(v); });
+	bench::report("sum, const_reverse_iterator", t, n);
+	bench::check(s1 == s2, "sum, const_reverse_iterator");
+	compare(ic, "sum, const_reverse_iterator vs raw pointer", ic.count([&]{ s1 = sum_reverse(v); }), ic.count([&]{ s2 = sum_pointer(&v[0], n); }), n);
+
+	t = bench::best(reps, [&]{ scale_iterator(v); });
+	bench::report("scale, iterator", t, n);
+	t = bench::best(reps, [&]{ scale_pointer(&v[0], n); });
+	bench::report("scale, raw pointer", t, n);
+	compare(ic, "scale, iterator vs raw pointer", ic.count([&]{ scale_iterator(v); }), ic.count([&]{ scale_pointer(&v[0], n); }), n);
+
+	return bench::finish();
+}
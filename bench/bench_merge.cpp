@@ -0,0 +1,141 @@
+// tiny::merge, the set operations and merge_n against <algorithm>, on
+// inputs of equal size and on skewed ones where galloping pays
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyAlgorithm.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <stdlib.h>
+#include <vector>
+
+using namespace tiny;
+
+static void sorted_input(vector<int> *v, size_t n, int range)
+{
+	v->clear();
+	for (size_t i = 0; i < n; i++) {
+		v->push_back(rand() % range);
+	}
+	tiny::sort(v->begin(), v->end());
+}
+
+// for the std algorithms, which take no tiny iterators
+static int const *begin_of(vector<int> const &v)
+{
+	return v.empty() ? 0 : &v[0];
+}
+
+static int const *end_of(vector<int> const &v)
+{
+	return begin_of(v) + v.size();
+}
+
+static bool same(vector<int> const &a, std::vector<int> const &b)
+{
+	if (a.size() != b.size()) return false;
+	return a.empty() || memcmp(&a[0], &b[0], sizeof(int) * a.size()) == 0;
+}
+
+static void pair(char const *label, vector<int> const &a, vector<int> const &b, int reps)
+{
+	size_t n = a.size() + b.size();
+	vector<int> out;
+	std::vector<int> expect;
+	char name[64];
+	double t;
+
+	t = bench::best(reps, [&]{ tiny::merge(a, b, out); });
+	snprintf(name, sizeof(name), "tiny::merge %s", label);
+	bench::report(name, t, n);
+	t = bench::best(reps, [&]{ expect.clear(); std::merge(begin_of(a), end_of(a), begin_of(b), end_of(b), std::back_inserter(expect)); });
+	snprintf(name, sizeof(name), "std::merge %s", label);
+	bench::report(name, t, n);
+	bench::check(same(out, expect), "tiny::merge");
+
+	t = bench::best(reps, [&]{ tiny::set_union(a, b, out); });
+	snprintf(name, sizeof(name), "tiny::set_union %s", label);
+	bench::report(name, t, n);
+	t = bench::best(reps, [&]{ expect.clear(); std::set_union(begin_of(a), end_of(a), begin_of(b), end_of(b), std::back_inserter(expect)); });
+	snprintf(name, sizeof(name), "std::set_union %s", label);
+	bench::report(name, t, n);
+	bench::check(same(out, expect), "tiny::set_union");
+
+	t = bench::best(reps, [&]{ tiny::set_intersection(a, b, out); });
+	snprintf(name, sizeof(name), "tiny::set_intersection %s", label);
+	bench::report(name, t, n);
+	t = bench::best(reps, [&]{ expect.clear(); std::set_intersection(begin_of(a), end_of(a), begin_of(b), end_of(b), std::back_inserter(expect)); });
+	snprintf(name, sizeof(name), "std::set_intersection %s", label);
+	bench::report(name, t, n);
+	bench::check(same(out, expect), "tiny::set_intersection");
+
+	t = bench::best(reps, [&]{ tiny::set_difference(a, b, out); });
+	snprintf(name, sizeof(name), "tiny::set_difference %s", label);
+	bench::report(name, t, n);
+	t = bench::best(reps, [&]{ expect.clear(); std::set_difference(begin_of(a), end_of(a), begin_of(b), end_of(b), std::back_inserter(expect)); });
+	snprintf(name, sizeof(name), "std::set_difference %s", label);
+	bench::report(name, t, n);
+	bench::check(same(out, expect), "tiny::set_difference");
+}
+
+int main(int argc, char **argv)
+{
+	size_t n = bench::quick(argc, argv) ? 20000 : 2000000;
+	int reps = bench::quick(argc, argv) ? 1 : 5;
+	srand(1);
+
+	vector<int> a, b;
+	sorted_input(&a, n, (int)n * 4);
+	sorted_input(&b, n, (int)n * 4);
+	pair("1:1", a, b, reps);
+	sorted_input(&b, n / 1000, (int)n * 4);
+	pair("1000:1", a, b, reps);
+
+	// k-way: merge_n against merging the inputs one after another and
+	// against sorting them all together
+	size_t k = 16;
+	vector<vector<int> > in;
+	in.resize(k);
+	for (size_t i = 0; i < k; i++) {
+		sorted_input(&in[i], n / k, (int)n * 4);
+	}
+	vector<int> out;
+	double t = bench::best(reps, [&]{ tiny::merge_n(in, out); });
+	bench::report("tiny::merge_n 16 way", t, n);
+	std::vector<int> expect, tmp;
+	t = bench::best(reps, [&]{
+		expect.clear();
+		for (size_t i = 0; i < k; i++) {
+			tmp.swap(expect);
+			expect.clear();
+			std::merge(tmp.begin(), tmp.end(), begin_of(in[i]), end_of(in[i]), std::back_inserter(expect));
+		}
+	});
+	bench::report("std::merge 16 times", t, n);
+	bench::check(same(out, expect), "tiny::merge_n");
+	t = bench::best(reps, [&]{
+		expect.clear();
+		for (size_t i = 0; i < k; i++) {
+			expect.insert(expect.end(), begin_of(in[i]), end_of(in[i]));
+		}
+		std::stable_sort(expect.begin(), expect.end());
+	});
+	bench::report("std::stable_sort of all 16", t, n);
+	bench::check(same(out, expect), "tiny::merge_n against stable_sort");
+
+	// element types from namespace std must not make the calls ambiguous
+	std::chrono::milliseconds ma[4], mb[4], mo[8];
+	for (int i = 0; i < 4; i++) {
+		ma[i] = std::chrono::milliseconds(i * 2);
+		mb[i] = std::chrono::milliseconds(i * 2 + 1);
+	}
+	std::chrono::milliseconds *me = tiny::merge(ma, ma + 4, mb, mb + 4, mo);
+	bench::check(me == mo + 8 && mo[7].count() == 7, "merge of std::chrono::milliseconds");
+	me = tiny::set_union(ma, ma + 4, mb, mb + 4, mo);
+	me = tiny::set_intersection(ma, ma + 4, mb, mb + 4, mo);
+	bench::check(me == mo, "set_intersection of std::chrono::milliseconds");
+	me = tiny::set_difference(ma, ma + 4, mb, mb + 4, mo);
+	bench::check(me == mo + 4, "set_difference of std::chrono::milliseconds");
+
+	return bench::finish();
+}
@@ -0,0 +1,88 @@
+// tiny::numeric kernels against element by element loops over the vector
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyNumeric.h"
+#include <stdlib.h>
+
+using namespace tiny;
+
+int main(int argc, char **argv)
+{
+	size_t n = bench::quick(argc, argv) ? 10003 : 4000003; // odd, so the tails run
+	int reps = bench::quick(argc, argv) ? 1 : 10;
+	vector<int16_t> a(n, 0);
+	vector<int16_t> b(n, 0);
+	vector<float> fa(n, 0.0f);
+	vector<float> fb(n, 0.0f);
+	srand(1);
+	for (size_t i = 0; i < n; i++) {
+		a[i] = (int16_t)(rand() % 2001 - 1000);
+		b[i] = (int16_t)(rand() % 2001 - 1000);
+		// small integers, so float sums are exact in any order
+		fa[i] = (float)(rand() % 17 - 8);
+		fb[i] = (float)(rand() % 17 - 8);
+	}
+
+	double t;
+	int32_t s1 = 0, s2 = 0;
+	t = bench::best(reps, [&]{ s1 = numeric::accumulate(a); bench::keep(s1); });
+	bench::report("numeric::accumulate int16", t, n);
+	t = bench::best(reps, [&]{ s2 = 0; for (vector<int16_t>::const_iterator it = a.begin(); it != a.end(); it++) s2 += *it; bench::keep(s2); });
+	bench::report("loop sum int16", t, n);
+	bench::check(s1 == s2, "accumulate int16");
+
+	t = bench::best(reps, [&]{ s1 = numeric::dot(a, b); bench::keep(s1); });
+	bench::report("numeric::dot int16", t, n);
+	t = bench::best(reps, [&]{ s2 = 0; for (size_t i = 0; i < n; i++) s2 += (int32_t)a[i] * b[i]; bench::keep(s2); });
+	bench::report("loop dot int16", t, n);
+	bench::check(s1 == s2, "dot int16");
+
+	int16_t lo1 = 0, hi1 = 0, lo2 = 0, hi2 = 0;
+	t = bench::best(reps, [&]{ numeric::minmax(a, &lo1, &hi1); bench::keep(lo1); });
+	bench::report("numeric::minmax int16", t, n);
+	t = bench::best(reps, [&]{ lo2 = hi2 = a[0]; for (vector<int16_t>::const_iterator it = a.begin(); it != a.end(); it++) { if (*it < lo2) lo2 = *it; if (hi2 < *it) hi2 = *it; } bench::keep(lo2); });
+	bench::report("loop minmax int16", t, n);
+	bench::check(lo1 == lo2 && hi1 == hi2, "minmax int16");
+
+	float f1 = 0, f2 = 0;
+	t = bench::best(reps, [&]{ f1 = numeric::accumulate(fa); bench::keep(f1); });
+	bench::report("numeric::accumulate float", t, n);
+	t = bench::best(reps, [&]{ f2 = 0; for (vector<float>::const_iterator it = fa.begin(); it != fa.end(); it++) f2 += *it; bench::keep(f2); });
+	bench::report("loop sum float", t, n);
+	bench::check(f1 == f2, "accumulate float");
+
+	t = bench::best(reps, [&]{ f1 = numeric::dot(fa, fb); bench::keep(f1); });
+	bench::report("numeric::dot float", t, n);
+	t = bench::best(reps, [&]{ f2 = 0; for (size_t i = 0; i < n; i++) f2 += fa[i] * fb[i]; bench::keep(f2); });
+	bench::report("loop dot float", t, n);
+	bench::check(f1 == f2, "dot float");
+
+	vector<int16_t> c1(a);
+	vector<int16_t> c2(a);
+	t = bench::best(reps, [&]{ numeric::transform(c1, numeric::clamp<int16_t>(-500, 500)); });
+	bench::report("numeric::transform clamp int16", t, n);
+	t = bench::best(reps, [&]{ for (vector<int16_t>::iterator it = c2.begin(); it != c2.end(); it++) *it = *it < -500 ? -500 : (500 < *it ? 500 : *it); });
+	bench::report("loop clamp int16", t, n);
+	bench::check(memcmp(&c1[0], &c2[0], sizeof(int16_t) * n) == 0, "transform clamp");
+
+	size_t k1 = 0, k2 = 0;
+	t = bench::best(reps, [&]{ k1 = numeric::count(a, (int16_t)0); bench::keep(k1); });
+	bench::report("numeric::count int16", t, n);
+	t = bench::best(reps, [&]{ k2 = 0; for (size_t i = 0; i < n; i++) k2 += a[i] == 0; bench::keep(k2); });
+	bench::report("loop count int16", t, n);
+	bench::check(k1 == k2, "count int16");
+
+	a[n - 1] = 30000; // out of the random range, found only at the end
+	t = bench::best(reps, [&]{ k1 = numeric::find(a, (int16_t)30000); bench::keep(k1); });
+	bench::report("numeric::find int16", t, n);
+	bench::check(k1 == n - 1, "find int16");
+	bench::check(numeric::find(a, (int16_t)31000) == numeric::npos, "find int16 missing");
+
+	vector<char> text(n, 'x');
+	text[n - 1] = 'y';
+	t = bench::best(reps, [&]{ k1 = numeric::find(text, 'y'); bench::keep(k1); });
+	bench::report("numeric::find char", t, n);
+	bench::check(k1 == n - 1, "find char");
+
+	return bench::finish();
+}
@@ -0,0 +1,91 @@
+// tiny::par scaling: each operation on pools of 1, 2, 4, ... threads,
+// with the speedup over the serial loop
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyParallel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <thread>
+
+using namespace tiny;
+
+static void speedup(char const *name, size_t threads, double serial, double t, size_t n)
+{
+	char label[64];
+	snprintf(label, sizeof(label), "%s, %u threads", name, (unsigned)threads);
+	bench::report(label, t, n);
+	printf("%-44s %12.2fx\n", "  speedup", t > 0 ? serial / t : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+	size_t n = bench::quick(argc, argv) ? 100000 : 8000000;
+	int reps = bench::quick(argc, argv) ? 1 : 5;
+	size_t hw = std::thread::hardware_concurrency();
+	size_t maxthreads = hw > 4 ? hw : 4;
+
+	vector<double> src(n, 0.0);
+	vector<int> keys(n, 0);
+	srand(1);
+	for (size_t i = 0; i < n; i++) {
+		src[i] = (double)(i % 1000);
+		keys[i] = rand();
+	}
+	vector<double> v;
+	vector<int> k;
+
+	// work per element heavy enough for the split to pay
+	struct op {
+		double operator () (double x) const
+		{
+			return sqrt(x) * sin(x) + cos(x);
+		}
+	};
+
+	double t;
+	double serial_transform = bench::best(reps, [&]{
+		v = src;
+		for (size_t i = 0; i < n; i++) {
+			v[i] = op()(v[i]);
+		}
+	});
+	bench::report("serial transform", serial_transform, n);
+	vector<double> expect(v);
+
+	double sum = 0;
+	double serial_reduce = bench::best(reps, [&]{
+		sum = 0;
+		for (size_t i = 0; i < n; i++) {
+			sum += src[i];
+		}
+		bench::keep(sum);
+	});
+	bench::report("serial reduce", serial_reduce, n);
+	double expect_sum = sum;
+
+	double serial_sort = bench::best(reps, [&]{ k = keys; tiny::sort(k.begin(), k.end()); });
+	bench::report("tiny::sort", serial_sort, n);
+
+	for (size_t threads = 1; threads <= maxthreads; threads *= 2) {
+		par::thread_pool pool(threads);
+
+		t = bench::best(reps, [&]{ v = src; par::transform(pool, v, op()); });
+		speedup("par::transform", threads, serial_transform, t, n);
+		bench::check(memcmp(&v[0], &expect[0], sizeof(double) * n) == 0, "par::transform");
+
+		t = bench::best(reps, [&]{ sum = par::reduce(pool, src, 0.0, [](double a, double b){ return a + b; }); bench::keep(sum); });
+		speedup("par::reduce", threads, serial_reduce, t, n);
+		// integer valued, so exact in any grouping
+		bench::check(sum == expect_sum, "par::reduce");
+
+		t = bench::best(reps, [&]{ k = keys; par::sort(pool, k, less()); });
+		speedup("par::sort", threads, serial_sort, t, n);
+		bool ok = true;
+		for (size_t i = 1; i < n; i++) {
+			ok = ok && !(k[i] < k[i - 1]);
+		}
+		bench::check(ok, "par::sort");
+	}
+
+	return bench::finish();
+}
@@ -0,0 +1,141 @@
+// serializer/deserializer round trip, zero-copy views against copying loads
+
+#include "bench/bench.h"
+#include "TinyContainer/TinySerialize.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// an image whose first record count is replaced, with the checksum
+// recomputed so that verifying does not catch it
+static void patch_count(tiny::serializer const &src, uint32_t count, tiny::vector<char> *img)
+{
+	img->assign(src.data(), src.data() + src.size());
+	memcpy(&(*img)[tiny::serial::HEADER_SIZE], &count, sizeof(count));
+	tiny::serial::header_t h;
+	memcpy(&h, &(*img)[0], sizeof(h));
+	h.checksum = tiny::adler32(&(*img)[0] + tiny::serial::HEADER_SIZE, h.payload_size);
+	memcpy(&(*img)[0], &h, sizeof(h));
+}
+
+static void corrupt_counts()
+{
+	tiny::serializer out;
+	out.write(tiny::string_view("abc"));
+	out.finish();
+	tiny::vector<char> img;
+	static const uint32_t counts[] = { 0xffffffffu, 0xfffffffeu, 0x80000000u, 4, 5 };
+	for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+		patch_count(out, counts[i], &img);
+		for (int verify = 0; verify < 2; verify++) {
+			tiny::deserializer in(&img[0], img.size(), verify != 0);
+			tiny::string_view s;
+			tiny::vector_view<char> v;
+			bool got = in.read(&s);
+			bench::check(!got && !in.valid(), "string with a count past the end");
+			tiny::deserializer in2(&img[0], img.size(), verify != 0);
+			got = in2.read(&v);
+			bench::check(!got || v.size() <= img.size(), "vector with a count past the end");
+		}
+	}
+	patch_count(out, 3, &img);
+	tiny::deserializer in(&img[0], img.size());
+	tiny::string_view s;
+	bench::check(in.read(&s) && s.size() == 3 && in.at_end(), "unpatched count reads back");
+}
+
+int main(int argc, char **argv)
+{
+	size_t records = bench::quick(argc, argv) ? 20 : 2000;
+	size_t len = 1000;
+	int reps = bench::quick(argc, argv) ? 1 : 5;
+	tiny::vector<tiny::vector<float> > data;
+	tiny::vector<tiny::string> names;
+	for (size_t i = 0; i < records; i++) {
+		tiny::vector<float> v;
+		for (size_t j = 0; j < len; j++) {
+			v.push_back((float)(i * len + j));
+		}
+		data.push_back(v);
+		char name[32];
+		snprintf(name, sizeof(name), "sensor-%u", (unsigned)i);
+		names.push_back(tiny::string(name));
+	}
+	size_t total = records * len;
+
+	tiny::serializer out;
+	double t = bench::best(reps, [&]{
+		out.clear();
+		out.reserve(total * sizeof(float) + records * 48);
+		for (size_t i = 0; i < records; i++) {
+			out.write(names[i]);
+			out.write(data[i]);
+		}
+		out.finish();
+	});
+	bench::report("serialize + checksum", t, total);
+
+	size_t sum = 0;
+	bool ok = true;
+	t = bench::best(reps, [&]{
+		tiny::deserializer in(out.data(), out.size());
+		tiny::vector_view<float> v;
+		tiny::string_view s;
+		sum = 0;
+		for (size_t i = 0; i < records; i++) {
+			ok = ok && in.read(&s) && in.read(&v) && v.size() == len;
+			sum += s.size();
+		}
+		ok = ok && in.at_end();
+	});
+	bench::report("load views (verify checksum)", t, total);
+	bench::check(ok, "round trip");
+
+	t = bench::best(reps, [&]{
+		tiny::deserializer in(out.data(), out.size(), false);
+		tiny::vector_view<float> v;
+		tiny::string_view s;
+		for (size_t i = 0; i < records; i++) {
+			in.read(&s);
+			in.read(&v);
+			bench::keep(v);
+		}
+	});
+	bench::report("load views (no verify)", t, total);
+
+	tiny::vector<tiny::vector<float> > copy;
+	t = bench::best(reps, [&]{
+		tiny::deserializer in(out.data(), out.size(), false);
+		tiny::vector_view<float> v;
+		tiny::string_view s;
+		copy.clear();
+		for (size_t i = 0; i < records; i++) {
+			in.read(&s);
+			in.read(&v);
+			copy.push_back(tiny::vector<float>(v.begin(), v.end()));
+		}
+	});
+	bench::report("load with copies into vectors", t, total);
+	bench::check(copy.size() == records && copy[records - 1][len - 1] == data[records - 1][len - 1], "copied values");
+
+	corrupt_counts();
+
+#ifdef TINY_HAVE_MMAP
+	char const *path = "bench_serialize.img";
+	bench::check(out.save(path), "save");
+	t = bench::best(reps, [&]{
+		tiny::mapped_file file(path);
+		tiny::deserializer in(file.data(), file.size());
+		tiny::vector_view<float> v;
+		tiny::string_view s;
+		for (size_t i = 0; i < records; i++) {
+			ok = ok && in.read(&s) && in.read(&v);
+			ok = ok && s == tiny::string_view(names[i]) && v[len - 1] == data[i][len - 1];
+		}
+	});
+	bench::report("mmap + load views (verify)", t, total);
+	bench::check(ok, "mapped round trip");
+	remove(path);
+#endif
+	return bench::finish();
+}
@@ -0,0 +1,82 @@
+// tiny::sort and friends against <algorithm>
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyAlgorithm.h"
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+
+static bool sorted(int const *p, size_t n)
+{
+	for (size_t i = 1; i < n; i++) {
+		if (p[i] < p[i - 1]) return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	size_t n = bench::quick(argc, argv) ? 10000 : 2000000;
+	int reps = bench::quick(argc, argv) ? 1 : 5;
+	std::vector<int> src(n);
+	srand(1);
+	for (size_t i = 0; i < n; i++) {
+		src[i] = rand();
+	}
+	tiny::vector<int> tv;
+	std::vector<int> sv;
+	tiny::vector<int> buf(n, 0);
+
+	double t;
+	t = bench::best(reps, [&]{ tv.assign(&src[0], &src[0] + n); tiny::sort(tv.begin(), tv.end()); });
+	bench::report("tiny::sort", t, n);
+	bench::check(sorted(&tv[0], n), "tiny::sort");
+	t = bench::best(reps, [&]{ sv.assign(src.begin(), src.end()); std::sort(sv.begin(), sv.end()); });
+	bench::report("std::sort", t, n);
+
+	t = bench::best(reps, [&]{ tv.assign(&src[0], &src[0] + n); tiny::stable_sort(tv.begin(), tv.end(), &buf[0], tiny::less()); });
+	bench::report("tiny::stable_sort (buffer)", t, n);
+	bench::check(sorted(&tv[0], n), "tiny::stable_sort");
+	t = bench::best(reps, [&]{ tv.assign(&src[0], &src[0] + n); tiny::stable_sort(tv.begin(), tv.end()); });
+	bench::report("tiny::stable_sort (in place)", t, n);
+	bench::check(sorted(&tv[0], n), "tiny::stable_sort in place");
+	t = bench::best(reps, [&]{ sv.assign(src.begin(), src.end()); std::stable_sort(sv.begin(), sv.end()); });
+	bench::report("std::stable_sort", t, n);
+
+	size_t k = n / 100;
+	t = bench::best(reps, [&]{ tv.assign(&src[0], &src[0] + n); tiny::partial_sort(tv.begin(), tv.begin() + k, tv.end()); });
+	bench::report("tiny::partial_sort 1%", t, n);
+	bench::check(sorted(&tv[0], k), "tiny::partial_sort");
+	t = bench::best(reps, [&]{ sv.assign(src.begin(), src.end()); std::partial_sort(sv.begin(), sv.begin() + k, sv.end()); });
+	bench::report("std::partial_sort 1%", t, n);
+
+	t = bench::best(reps, [&]{ tv.assign(&src[0], &src[0] + n); tiny::nth_element(tv.begin(), tv.begin() + n / 2, tv.end()); });
+	bench::report("tiny::nth_element", t, n);
+	sv.assign(src.begin(), src.end());
+	std::nth_element(sv.begin(), sv.begin() + n / 2, sv.end());
+	bench::check(tv[n / 2] == sv[n / 2], "tiny::nth_element");
+	t = bench::best(reps, [&]{ sv.assign(src.begin(), src.end()); std::nth_element(sv.begin(), sv.begin() + n / 2, sv.end()); });
+	bench::report("std::nth_element", t, n);
+
+	tv.assign(&src[0], &src[0] + n);
+	tiny::sort(tv.begin(), tv.end());
+	size_t hits = 0;
+	t = bench::best(reps, [&]{ hits = 0; for (size_t i = 0; i < n; i++) hits += tiny::binary_search(tv.begin(), tv.end(), src[i]); });
+	bench::report("tiny::binary_search", t, n);
+	bench::check(hits == n, "tiny::binary_search");
+
+	// element types from namespace std must not make swap ambiguous
+	std::chrono::milliseconds ms[64];
+	for (int i = 0; i < 64; i++) {
+		ms[i] = std::chrono::milliseconds((i * 37) % 64);
+	}
+	tiny::sort(ms, ms + 64);
+	tiny::partial_sort(ms, ms + 8, ms + 64);
+	tiny::nth_element(ms, ms + 32, ms + 64);
+	tiny::make_heap(ms, ms + 64);
+	tiny::pop_heap(ms, ms + 64);
+	bench::check(ms[63].count() == 63, "sort of std::chrono::milliseconds");
+
+	return bench::finish();
+}
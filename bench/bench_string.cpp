@@ -0,0 +1,123 @@
+// tiny::string appends and c_str() in each layout: built once and read
+// once, and read after every append. Also counts the allocations made by
+// the c_str() calls alone, and checks appending a string to itself.
+
+#define TINY_ALLOC_STATS
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include <string.h>
+
+using namespace tiny;
+
+static char const *layout_name(string_layout l)
+{
+	return l == STRING_AUTO ? "auto" : (l == STRING_CONTIGUOUS ? "contiguous" : "fragments");
+}
+
+// appends n pieces, calling c_str() every `every` appends and at the end;
+// returns the allocations made inside c_str()
+static size_t build(string &s, string_layout l, size_t n, size_t every)
+{
+	static const char piece[] = "sensor=21.5;";
+	size_t in_c_str = 0;
+	s.clear();
+	s.set_layout(l);
+	for (size_t i = 1; i <= n; i++) {
+		s.print(piece, sizeof(piece) - 1);
+		if (i % every == 0 || i == n) {
+			size_t before = allocation_stats().allocations;
+			bench::keep(s.c_str()[0]);
+			in_c_str += allocation_stats().allocations - before;
+		}
+	}
+	return in_c_str;
+}
+
+static void run(char const *pattern, size_t n, size_t every, int reps, size_t *c_str_allocs)
+{
+	static const string_layout layouts[] = { STRING_AUTO, STRING_CONTIGUOUS, STRING_FRAGMENTS };
+	string expect;
+	// each once untimed, so that the first layout does not pay for
+	// warming up the heap
+	for (size_t i = 0; i < 3; i++) {
+		string s;
+		build(s, layouts[i], n, every);
+	}
+	for (size_t i = 0; i < 3; i++) {
+		string s;
+		double t = bench::best(reps, [&]{ build(s, layouts[i], n, every); });
+		char name[64];
+		snprintf(name, sizeof(name), "%s, %s", pattern, layout_name(layouts[i]));
+		bench::report(name, t, n);
+		c_str_allocs[i] = build(s, layouts[i], n, every);
+		reset_allocation_stats();
+		size_t before = allocation_stats().allocations;
+		bench::keep(s.c_str()[0]);
+		printf("%-44s %12u c_str allocations\n", "", (unsigned)c_str_allocs[i]);
+		bench::check(allocation_stats().allocations == before, "c_str() of a joined string allocates nothing");
+		if (i == 0) {
+			expect = s;
+		} else {
+			bench::check(s.size() == expect.size() && strcmp(s.c_str(), expect.c_str()) == 0, name);
+		}
+	}
+}
+
+// appending a string to itself, and a piece of itself, which may regrow
+// the buffer being read from
+static void self_append()
+{
+	static const string_layout layouts[] = { STRING_AUTO, STRING_CONTIGUOUS, STRING_FRAGMENTS };
+	for (int i = 0; i < 3; i++) {
+		string s;
+		s.set_layout(layouts[i]);
+		s.print("abcdefghij");
+		s.print("klmnopqrstuvwxyz0123456789");
+		bench::keep(s.c_str()[0]);
+		s += s;
+		bench::check(s.size() == 72 && strcmp(s.c_str() + 36, "abcdefghijklmnopqrstuvwxyz0123456789") == 0, "s += s");
+		s.print(s);
+		bench::check(s.size() == 144 && memcmp(s.c_str() + 108, "abcdefghij", 10) == 0 && s.c_str()[144] == 0, "s.print(s)");
+		s.print(s.c_str() + 2, 5);
+		bench::check(s.size() == 149 && strcmp(s.c_str() + 144, "cdefg") == 0, "s.print of a piece of s");
+
+		// not read back in between, so still in several fragments
+		string t;
+		t.set_layout(layouts[i]);
+		t.print("0123456789");
+		t.print("abcdefghijklmnopqrstuvwxyz");
+		t.print(t);
+		bench::check(t.size() == 72 && strcmp(t.c_str() + 36, "0123456789abcdefghijklmnopqrstuvwxyz") == 0, "s.print(s) of unjoined text");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	size_t n = bench::quick(argc, argv) ? 2000 : 100000;
+	// reading after every append joins the fragments each time, which is
+	// quadratic in the fragments layout
+	size_t m = bench::quick(argc, argv) ? 500 : 10000;
+	int reps = bench::quick(argc, argv) ? 1 : 5;
+	size_t allocs[3];
+
+	run("append n, c_str once", n, n, reps, allocs);
+	bench::check(allocs[0] == 1, "auto joins once");
+	bench::check(allocs[1] == 0, "contiguous c_str never allocates");
+	bench::check(allocs[2] == 1, "fragments joins once");
+
+	run("append, c_str after each", m, 1, reps, allocs);
+	bench::check(allocs[0] <= 1, "auto joins once, then stays contiguous");
+	bench::check(allocs[1] == 0, "contiguous c_str never allocates");
+	bench::check(allocs[2] >= allocs[0], "fragments joins on every c_str");
+
+	// a layout set on one copy of a shared string is not seen by the others
+	string a("shared text");
+	string b = a;
+	b.set_layout(STRING_FRAGMENTS);
+	bench::check(a.layout() == STRING_AUTO && b.layout() == STRING_FRAGMENTS, "set_layout detaches a shared string");
+	bench::check(strcmp(a.c_str(), b.c_str()) == 0, "set_layout keeps the text");
+
+	self_append();
+
+	return bench::finish();
+}
@@ -0,0 +1,289 @@
+// Allocation and instruction count gate. Each operation below is run on
+// a fresh container; the allocations it makes (TINY_ALLOC_STATS) and,
+// where perf events are available, the user space instructions it runs
+// are compared with tests/alloc_baseline.txt. Allocation counts are exact
+// and must not grow at all; instruction counts may grow by THRESHOLD
+// percent. A baseline of 0 instructions, written on a host without
+// perf events, fails the check where they are available. Every operation
+// must also free everything it allocated. The operations are a sample of
+// each container's common paths, not every public member.
+//
+//   test_alloc_gate <baseline>            check
+//   test_alloc_gate <baseline> --update   rewrite the baseline with the
+//                                         counts measured here
+
+#define TINY_ALLOC_STATS
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include "TinyContainer/TinyBTree.h"
+#include "TinyContainer/TinyDeque.h"
+#include "TinyContainer/TinyForwardList.h"
+#include "TinyContainer/TinyPriorityQueue.h"
+#include <functional>
+#include <stdlib.h>
+
+static const unsigned THRESHOLD = 10; // percent, for instruction counts
+
+typedef std::function<void ()> F;
+// measure(f) runs f and records what it does
+typedef std::function<void (F const &)> M;
+
+struct op_t {
+	char const *name;
+	std::function<void (M const &measure)> run;
+};
+
+struct result_t {
+	char name[64];
+	unsigned long long allocations;
+	unsigned long long instructions; // 0 if not measured
+};
+
+static bench::instruction_counter counter;
+static const tiny::literal constant_text("constant text");
+// hides which object the literal is from GCC, which otherwise warns about
+// the free on the heap core path of the string destructor
+static tiny::literal const *volatile literal_ptr = &constant_text;
+
+// runs setup, then the measured part through measure(), then teardown,
+// all inside op.run
+static result_t measure(op_t const &op)
+{
+	result_t r;
+	snprintf(r.name, sizeof(r.name), "%s", op.name);
+	r.allocations = 0;
+	r.instructions = 0;
+	tiny::reset_allocation_stats();
+	op.run([&](F const &f){
+		size_t before = tiny::allocation_stats().allocations;
+		if (counter.available()) {
+			r.instructions = counter.count(f);
+		} else {
+			f();
+		}
+		r.allocations = tiny::allocation_stats().allocations - before;
+	});
+	tiny::alloc_stats const &s = tiny::allocation_stats();
+	if (s.allocations != s.frees) {
+		printf("%s: %u allocations but %u frees\n", op.name, (unsigned)s.allocations, (unsigned)s.frees);
+		bench::check(false, "everything allocated is freed");
+	}
+	return r;
+}
+
+static size_t load(char const *path, result_t *out, size_t max)
+{
+	FILE *fp = fopen(path, "r");
+	if (!fp) return 0;
+	size_t n = 0;
+	char line[256];
+	while (n < max && fgets(line, sizeof(line), fp)) {
+		if (line[0] == '#' || line[0] == '\n') continue;
+		result_t r;
+		if (sscanf(line, "%63s %llu %llu", r.name, &r.allocations, &r.instructions) == 3) {
+			out[n++] = r;
+		}
+	}
+	fclose(fp);
+	return n;
+}
+
+static result_t const *find(result_t const *v, size_t n, char const *name)
+{
+	for (size_t i = 0; i < n; i++) {
+		if (strcmp(v[i].name, name) == 0) return &v[i];
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		printf("usage: %s <baseline> [--update]\n", argv[0]);
+		return 2;
+	}
+	bool update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+	op_t ops[] = {
+		{ "vector_push_back_1000", [](M const &m){
+			tiny::vector<int> v;
+			m([&]{ for (int i = 0; i < 1000; i++) v.push_back(i); });
+		} },
+		{ "vector_reserve_push_back_1000", [](M const &m){
+			tiny::vector<int> v;
+			m([&]{ v.reserve(1000); for (int i = 0; i < 1000; i++) v.push_back(i); });
+		} },
+		{ "vector_resize_1000_by_1", [](M const &m){
+			tiny::vector<int> v;
+			m([&]{ for (size_t i = 1; i <= 1000; i++) v.resize(i); });
+		} },
+		{ "vector_copy_1000", [](M const &m){
+			tiny::vector<int> v(1000, 7);
+			m([&]{ tiny::vector<int> c(v); bench::keep(c[999]); });
+		} },
+		{ "vector_insert_erase_middle", [](M const &m){
+			tiny::vector<int> v(1000, 7);
+			v.reserve(1100);
+			m([&]{ for (int i = 0; i < 100; i++) v.insert(v.begin() + 500, i); for (int i = 0; i < 100; i++) v.erase(v.begin() + 500); });
+		} },
+		{ "vector_erase_range", [](M const &m){
+			tiny::vector<int> v(1000, 7);
+			m([&]{ v.erase(v.begin() + 100, v.begin() + 900); bench::keep(v.size()); });
+		} },
+		{ "vector_assign_range", [](M const &m){
+			tiny::vector<int> a(1000, 7);
+			tiny::vector<int> v;
+			m([&]{ v.assign(a.begin(), a.end()); bench::keep(v.size()); });
+		} },
+		{ "vector_assign_fill", [](M const &m){
+			tiny::vector<int> v;
+			m([&]{ v.assign(1000, 7); bench::keep(v.size()); });
+		} },
+		{ "vector_insert_range", [](M const &m){
+			tiny::vector<int> a(500, 7);
+			tiny::vector<int> v(500, 3);
+			m([&]{ v.insert(v.begin() + 250, a.begin(), a.end()); bench::keep(v.size()); });
+		} },
+		{ "list_push_back_100", [](M const &m){
+			tiny::list<int> l;
+			m([&]{ for (int i = 0; i < 100; i++) l.push_back(i); });
+		} },
+		{ "list_copy_100", [](M const &m){
+			tiny::list<int> l;
+			for (int i = 0; i < 100; i++) l.push_back(i);
+			m([&]{ tiny::list<int> c(l); bench::keep(c.size()); });
+		} },
+		{ "list_insert_erase_middle", [](M const &m){
+			tiny::list<int> l;
+			for (int i = 0; i < 100; i++) l.push_back(i);
+			m([&]{
+				tiny::list<int>::iterator it = l.begin();
+				for (int i = 0; i < 50; i++) it++;
+				for (int i = 0; i < 100; i++) l.insert(it, i);
+				for (int i = 0; i < 100; i++) { tiny::list<int>::iterator e = it; e--; l.erase(e); }
+			});
+		} },
+		{ "forward_list_push_back_100", [](M const &m){
+			tiny::forward_list<int> l;
+			m([&]{ for (int i = 0; i < 100; i++) l.push_back(i); });
+		} },
+		{ "deque_push_both_1000", [](M const &m){
+			tiny::deque<int> d;
+			m([&]{ for (int i = 0; i < 500; i++) { d.push_back(i); d.push_front(i); } });
+		} },
+		{ "priority_queue_push_pop_1000", [](M const &m){
+			tiny::priority_queue<int> q;
+			m([&]{ for (int i = 0; i < 1000; i++) q.push((i * 7919) % 1000); while (!q.empty()) q.pop(); });
+		} },
+		{ "btree_map_insert_1000", [](M const &m){
+			tiny::btree_map<int, int> t;
+			m([&]{ for (int i = 0; i < 1000; i++) t.insert((i * 7919) % 1000, i); });
+		} },
+		{ "btree_map_empty", [](M const &m){
+			m([&]{ tiny::btree_map<int, int> t; bench::keep(t.size()); });
+		} },
+		{ "string_literal", [](M const &m){
+			m([&]{ tiny::string s = *literal_ptr; bench::keep(s.c_str()[0]); });
+		} },
+		{ "string_copy_shared", [](M const &m){
+			tiny::string s("some text");
+			m([&]{ tiny::string c = s; bench::keep(c.c_str()[0]); });
+		} },
+		{ "string_print_100", [](M const &m){
+			tiny::string s;
+			m([&]{ for (int i = 0; i < 100; i++) s.print("0123456789"); });
+		} },
+		{ "string_print_100_c_str", [](M const &m){
+			tiny::string s;
+			m([&]{ for (int i = 0; i < 100; i++) s.print("0123456789"); bench::keep(s.c_str()[0]); });
+		} },
+		{ "string_contiguous_print_100_c_str", [](M const &m){
+			tiny::string s;
+			s.set_layout(tiny::STRING_CONTIGUOUS);
+			m([&]{ for (int i = 0; i < 100; i++) { s.print("0123456789"); bench::keep(s.c_str()[0]); } });
+		} },
+		{ "string_reserve_print_100", [](M const &m){
+			tiny::string s;
+			m([&]{ s.reserve(1000); for (int i = 0; i < 100; i++) s.print("0123456789"); bench::keep(s.c_str()[0]); });
+		} },
+		{ "string_compare", [](M const &m){
+			tiny::string a("some text that is compared");
+			tiny::string b("some text that is compared");
+			m([&]{ bench::keep(a.compare(b)); bench::keep(a == b); });
+		} },
+		{ "string_clear_print", [](M const &m){
+			tiny::string s;
+			s.print("0123456789");
+			m([&]{ s.clear(); s.print("0123456789"); bench::keep(s.c_str()[0]); });
+		} },
+		{ "string_compact", [](M const &m){
+			tiny::string s;
+			for (int i = 0; i < 100; i++) s.print("0123456789");
+			m([&]{ s.compact(); bench::keep(s.c_str()[0]); });
+		} },
+		{ "string_literal_print", [](M const &m){
+			tiny::string s = *literal_ptr;
+			m([&]{ s.print("!"); bench::keep(s.c_str()[0]); });
+		} },
+	};
+	size_t nops = sizeof(ops) / sizeof(ops[0]);
+
+	result_t base[64];
+	size_t nbase = load(argv[1], base, 64);
+	if (!update && nbase == 0) {
+		printf("no baseline in %s\n", argv[1]);
+		return 1;
+	}
+	if (!counter.available()) {
+		printf("instruction counts not available, checking allocations only\n");
+	}
+
+	result_t now[64];
+	for (size_t i = 0; i < nops; i++) {
+		now[i] = measure(ops[i]);
+		result_t const *b = find(base, nbase, ops[i].name);
+		printf("%-40s %6llu allocations %12llu instructions", now[i].name, now[i].allocations, now[i].instructions);
+		if (b) printf("   (baseline %llu, %llu)", b->allocations, b->instructions);
+		printf("\n");
+		if (update) {
+			// keep the old instruction count if it cannot be measured here
+			if (!now[i].instructions && b) now[i].instructions = b->instructions;
+			continue;
+		}
+		if (!b) {
+			printf("  no baseline for %s\n", ops[i].name);
+			bench::check(false, "every operation has a baseline");
+			continue;
+		}
+		if (now[i].allocations > b->allocations) {
+			bench::check(false, ops[i].name);
+			printf("  allocations went up from %llu to %llu\n", b->allocations, now[i].allocations);
+		}
+		if (now[i].instructions && !b->instructions) {
+			// measurable here, but the baseline was written where it was not
+			bench::check(false, ops[i].name);
+			printf("  no instruction baseline; regenerate it here with --update\n");
+		}
+		if (now[i].instructions && b->instructions && now[i].instructions * 100 > b->instructions * (100 + THRESHOLD)) {
+			bench::check(false, ops[i].name);
+			printf("  instructions went up more than %u%%\n", THRESHOLD);
+		}
+	}
+
+	if (update) {
+		FILE *fp = fopen(argv[1], "w");
+		if (!fp) {
+			printf("cannot write %s\n", argv[1]);
+			return 1;
+		}
+		fprintf(fp, "# Baseline for tests/test_alloc_gate.cpp: operation, allocations,\n");
+		fprintf(fp, "# user space instructions (0: not measured yet, which fails the check\n");
+		fprintf(fp, "# on a host with perf events). Regenerate with\n");
+		fprintf(fp, "#   test_alloc_gate tests/alloc_baseline.txt --update\n");
+		for (size_t i = 0; i < nops; i++) {
+			fprintf(fp, "%s %llu %llu\n", now[i].name, now[i].allocations, now[i].instructions);
+		}
+		fclose(fp);
+	}
+	return bench::finish();
+}
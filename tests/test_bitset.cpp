@@ -0,0 +1,24 @@
+// bitset ranges stay within N
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyBitset.h"
+
+int main()
+{
+	tiny::bitset<70> a;
+	a.set_range(60, 200);
+	bench::check(a.count() == 10, "set_range clamped to N");
+	tiny::bitset<70> b;
+	b.set_range(60, 70);
+	bench::check(a == b, "no bits past N");
+	a.reset_range(0, 1000);
+	bench::check(a.none(), "reset_range clamped to N");
+	tiny::bitset<64> c;
+	c.set_range(0, 65);
+	bench::check(c.count() == 64 && c.all(), "full word");
+
+	tiny::bitvector v(70);
+	v.set_range(60, 200);
+	bench::check(v.count() == 10, "bitvector set_range");
+	return bench::finish();
+}
@@ -0,0 +1,190 @@
+// btree_map and btree_set against a sorted model: random inserts, erases,
+// finds and range scans, bulk_load, copies, and an allocator that fails
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyBTree.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+// fails every fail_every-th allocation, or the fail_at-th from now
+struct failing_allocator {
+	static long fail_at;
+	static long fail_every;
+	static long calls;
+	static long live;
+	void *allocate(size_t n)
+	{
+		calls++;
+		if (fail_at > 0 && --fail_at == 0) return 0;
+		if (fail_every > 0 && calls % fail_every == 0) return 0;
+		live++;
+		return malloc(n);
+	}
+	void deallocate(void *p, size_t)
+	{
+		live--;
+		free(p);
+	}
+};
+
+long failing_allocator::fail_at = 0;
+long failing_allocator::fail_every = 0;
+long failing_allocator::calls = 0;
+long failing_allocator::live = 0;
+
+// small nodes, so that a few thousand keys make a tree several levels deep
+typedef tiny::btree_map<int, int, tiny::less, 64, failing_allocator> map_t;
+typedef tiny::btree_set<int, tiny::less, 64> set_t;
+typedef std::vector<std::pair<int, int> > model_t;
+
+static model_t::iterator model_lower(model_t &m, int k)
+{
+	return std::lower_bound(m.begin(), m.end(), std::make_pair(k, -2147483647 - 1));
+}
+
+static bool agrees(map_t const &t, model_t const &m)
+{
+	if (t.size() != m.size()) return false;
+	model_t::const_iterator r = m.begin();
+	for (map_t::iterator it = t.begin(); it != t.end(); it++, r++) {
+		if (r == m.end() || it->key != r->first || it->value != r->second) return false;
+	}
+	return r == m.end();
+}
+
+// [lo, hi) through lower_bound, against the model
+static bool scan(map_t const &t, model_t &m, int lo, int hi)
+{
+	map_t::iterator it = t.lower_bound(lo);
+	model_t::iterator r = model_lower(m, lo);
+	for (; r != m.end() && r->first < hi; r++, it++) {
+		if (it == t.end() || it.key() != r->first) return false;
+	}
+	return it == t.end() || !(it.key() < hi);
+}
+
+static void random_ops(long fail_every, char const *name)
+{
+	map_t t;
+	model_t m;
+	bool ok = true;
+	failing_allocator::fail_every = fail_every;
+	for (int i = 0; i < 4000 && ok; i++) {
+		int k = rand() % 1500;
+		int op = rand() % 5;
+		model_t::iterator r = model_lower(m, k);
+		bool present = r != m.end() && r->first == k;
+		if (op < 2) {
+			bool inserted = t.insert(k, i);
+			if (inserted) {
+				ok = !present;
+				m.insert(r, std::make_pair(k, i));
+			} else {
+				// present, or out of memory and unchanged
+				ok = present || !t.contains(k);
+			}
+		} else if (op == 2) {
+			ok = t.erase(k) == present;
+			if (present) m.erase(r);
+		} else if (op == 3) {
+			int *v = t.get(k);
+			ok = (v != 0) == present && (!v || *v == r->second);
+		} else {
+			ok = scan(t, m, k, k + rand() % 200);
+			map_t::iterator u = t.upper_bound(k);
+			model_t::iterator ru = present ? r + 1 : r;
+			ok = ok && (ru == m.end() ? u == t.end() : u != t.end() && u.key() == ru->first);
+		}
+	}
+	failing_allocator::fail_every = 0;
+	bench::check(ok && agrees(t, m), name);
+
+	map_t c(t);
+	bench::check(agrees(c, m), "copy");
+	// the copy fails part way at each allocation in turn
+	bool copies = true;
+	for (long f = 1; f < 30; f++) {
+		failing_allocator::fail_at = f;
+		map_t d(t);
+		failing_allocator::fail_at = 0;
+		copies = copies && (d.empty() ? d.begin() == d.end() : agrees(d, m));
+		copies = copies && d.insert(-1, 0) && d.contains(-1);
+	}
+	bench::check(copies, "copy under failure");
+
+	// erase everything, which only removes nodes once they are empty
+	for (model_t::iterator it = m.begin(); it != m.end(); it++) {
+		ok = ok && t.erase(it->first);
+	}
+	bench::check(ok && t.empty() && t.begin() == t.end() && !t.contains(m.empty() ? 0 : m[0].first), "erase everything");
+	t.insert(5, 5);
+	bench::check(t.size() == 1 && *t.get(5) == 5, "insert after erasing everything");
+}
+
+int main()
+{
+	srand(1);
+	random_ops(0, "random ops");
+	random_ops(7, "random ops, every 7th allocation failing");
+	random_ops(3, "random ops, every 3rd allocation failing");
+	bench::check(failing_allocator::live == 0, "every node freed");
+
+	// an empty tree has no nodes, and its first insert can fail
+	{
+		map_t e;
+		bench::check(e.begin() == e.end() && e.lower_bound(3) == e.end() && !e.erase(3), "empty tree");
+		failing_allocator::fail_at = 1;
+		bench::check(!e.insert(1, 1) && e.empty() && e.begin() == e.end(), "failed first insert");
+		e[2] = 20;
+		bench::check(*e.get(2) == 20, "operator []");
+		bench::check(failing_allocator::live == 1, "one leaf");
+	}
+
+	// bulk_load against inserting one by one; duplicates are dropped
+	std::vector<int> keys;
+	for (int i = 0; i < 3000; i++) {
+		keys.push_back(rand() % 5000);
+	}
+	std::sort(keys.begin(), keys.end());
+	set_t a, b;
+	bench::check(a.bulk_load(keys.begin(), keys.end()), "bulk_load");
+	for (size_t i = 0; i < keys.size(); i++) {
+		b.insert(keys[i]);
+	}
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	bool same = a.size() == keys.size() && b.size() == keys.size();
+	set_t::iterator ia = a.begin(), ib = b.begin();
+	for (size_t i = 0; same && i < keys.size(); i++, ia++, ib++) {
+		same = *ia == keys[i] && *ib == keys[i];
+	}
+	bench::check(same && ia == a.end() && ib == b.end(), "bulk_load matches inserts");
+	bool found = true;
+	for (int k = -1; k < 5001; k += 7) {
+		bool expect = std::binary_search(keys.begin(), keys.end(), k);
+		found = found && a.contains(k) == expect && (a.lower_bound(k) == a.end() || !(*a.lower_bound(k) < k));
+	}
+	bench::check(found, "find and lower_bound after bulk_load");
+	a.insert(-5);
+	a.erase(keys[0]);
+	bench::check(*a.begin() == -5 && !a.contains(keys[0]), "insert and erase after bulk_load");
+	bench::check(a.bulk_load(keys.begin(), keys.begin()) && a.empty(), "bulk_load of nothing");
+
+	// bulk_load failing at each allocation leaves an empty tree
+	map_t src;
+	for (int i = 0; i < 500; i++) {
+		src.insert(i, i);
+	}
+	bool loads = true;
+	for (long f = 1; f < 40; f++) {
+		map_t d;
+		d.insert(7, 7);
+		failing_allocator::fail_at = f;
+		bool ok = d.bulk_load(src.begin(), src.end());
+		failing_allocator::fail_at = 0;
+		loads = loads && (ok ? d.size() == 500 : d.empty() && d.begin() == d.end());
+	}
+	bench::check(loads, "bulk_load under failure");
+
+	return bench::finish();
+}
@@ -0,0 +1,75 @@
+// With TINY_CHECKED, misuse of indices and iterators reaches the check
+// handler instead of reading out of bounds.
+
+#define TINY_CHECKED
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include "TinyContainer/TinyForwardList.h"
+#include "TinyContainer/TinyIntrusiveList.h"
+#include <setjmp.h>
+
+static jmp_buf trap;
+
+static void handler(char const *, char const *, int)
+{
+	longjmp(trap, 1);
+}
+
+// true if f() failed a check
+template <typename F> static bool traps(F f)
+{
+	if (setjmp(trap)) {
+		return true;
+	}
+	f();
+	return false;
+}
+
+struct item {
+	int value;
+	tiny::list_hook hook;
+};
+
+int main()
+{
+	tiny::set_check_handler(handler);
+
+	tiny::vector<int> v;
+	for (int i = 0; i < 4; i++) {
+		v.push_back(i);
+	}
+	bench::check(!traps([&]{ bench::keep(v[3]); }), "vector index in range");
+	bench::check(traps([&]{ bench::keep(v[4]); }), "vector index out of range");
+	bench::check(traps([&]{ bench::keep(*v.end()); }), "vector end dereferenced");
+	bench::check(traps([&]{
+		tiny::vector<int>::iterator it = v.begin() + 3;
+		v.erase(v.begin());
+		bench::keep(*it);
+	}), "vector iterator invalidated by erase");
+
+	tiny::list<int> l;
+	l.push_back(1);
+	bench::check(traps([&]{ bench::keep(*l.end()); }), "list end dereferenced");
+
+	tiny::forward_list<int> f;
+	f.push_back(1);
+	f.push_back(2);
+	bench::check(!traps([&]{ bench::keep(*(f.begin() + 1)); }), "forward_list in range");
+	bench::check(traps([&]{ bench::keep(*f.end()); }), "forward_list end dereferenced");
+	bench::check(traps([&]{ f.end()++; }), "forward_list moved past the end");
+	bench::check(traps([&]{ bench::keep(*(f.begin() + 3)); }), "forward_list advanced past the end");
+
+	tiny::intrusive_list<item, &item::hook> il;
+	item a, b;
+	a.value = 1;
+	b.value = 2;
+	il.push_back(a);
+	il.push_back(b);
+	tiny::intrusive_list<item, &item::hook>::iterator it = il.begin();
+	bench::check(!traps([&]{ bench::keep(it->value); }), "intrusive_list linked");
+	a.hook.unlink();
+	bench::check(traps([&]{ bench::keep(it->value); }), "intrusive_list unlinked element dereferenced");
+	bench::check(traps([&]{ it++; }), "intrusive_list stepped from an unlinked element");
+
+	return bench::finish();
+}
@@ -0,0 +1,125 @@
+// shrink_to_fit, string compact(), compact_hook and heap_compact(),
+// including when the allocator fails
+
+#define TINY_ALLOC_STATS
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+// the allocation that fails: 1 is the next one, 0 none
+static long fail_at = 0;
+
+void *operator new[](size_t n, std::nothrow_t const &) noexcept
+{
+	if (fail_at > 0 && --fail_at == 0) {
+		return 0;
+	}
+	return malloc(n ? n : 1);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+// takes part in heap_compact() through its own compact() overload
+struct counted {
+	int calls;
+	bool result;
+};
+
+static bool compact(counted &c)
+{
+	c.calls++;
+	return c.result;
+}
+
+static void vectors()
+{
+	tiny::vector<int> v;
+	bench::check(v.shrink_to_fit() && v.capacity() == 0, "shrink_to_fit of an empty vector");
+	for (int i = 0; i < 100; i++) {
+		v.push_back(i);
+	}
+	v.resize(10);
+	bench::check(v.capacity() > 10, "capacity left after resize");
+	bench::check(v.shrink_to_fit() && v.capacity() == 10 && v.size() == 10 && v[9] == 9, "shrink_to_fit");
+	size_t frees = tiny::allocation_stats().frees;
+	bench::check(v.shrink_to_fit() && tiny::allocation_stats().frees == frees, "shrink_to_fit when already tight");
+
+	v.reserve(50);
+	fail_at = 1;
+	bench::check(!v.shrink_to_fit() && v.capacity() >= 50 && v.size() == 10 && v[9] == 9, "failed shrink_to_fit leaves the vector");
+	fail_at = 0;
+
+	v.clear();
+	frees = tiny::allocation_stats().frees;
+	bench::check(v.shrink_to_fit() && v.capacity() == 0, "emptied vector gives its buffer back");
+	bench::check(tiny::allocation_stats().frees == frees + 1, "the buffer is freed");
+}
+
+static void strings()
+{
+	tiny::string s;
+	for (int i = 0; i < 20; i++) {
+		s.print("0123456789");
+	}
+	bench::check(s.compact(), "compact");
+	bench::check(s.size() == 200 && memcmp(s.c_str(), "0123456789", 10) == 0 && s.c_str()[200] == 0, "compact keeps the text and the NUL");
+	size_t allocs = tiny::allocation_stats().allocations;
+	bench::check(s.compact() && tiny::allocation_stats().allocations == allocs, "compact when already compact");
+
+	tiny::string t;
+	t.set_layout(tiny::STRING_FRAGMENTS);
+	for (int i = 0; i < 20; i++) {
+		t.print("abcdefghij");
+	}
+	fail_at = 1;
+	bench::check(!t.compact(), "compact fails without memory");
+	fail_at = 0;
+	bench::check(t.size() == 200 && memcmp(t.c_str() + 190, "abcdefghij", 10) == 0, "failed compact keeps the text");
+
+	tiny::string e;
+	e.print("x");
+	e.clear();
+	bench::check(e.compact() && e.size() == 0 && e.c_str()[0] == 0, "compact of an emptied string");
+}
+
+static void hooks()
+{
+	counted a = { 0, true };
+	counted b = { 0, false };
+	tiny::compact_hook ha(a);
+	{
+		tiny::compact_hook hb(b);
+		bench::check(tiny::heap_compact() == 1 && a.calls == 1 && b.calls == 1, "heap_compact counts failures");
+	}
+	bench::check(tiny::heap_compact() == 0 && a.calls == 2 && b.calls == 1, "hook unregisters itself on destruction");
+
+	// real containers, with the allocator failing
+	tiny::vector<int> v;
+	tiny::string s;
+	s.set_layout(tiny::STRING_FRAGMENTS);
+	for (int i = 0; i < 100; i++) {
+		v.push_back(i);
+		s.print("abc");
+	}
+	v.resize(10);
+	tiny::compact_hook hv(v);
+	tiny::compact_hook hs(s);
+	fail_at = 1;
+	size_t failed = tiny::heap_compact();
+	fail_at = 0;
+	bench::check(failed == 1, "heap_compact counts the container that could not be compacted");
+	bench::check(tiny::heap_compact() == 0 && v.capacity() == 10 && s.size() == 300, "heap_compact when memory is back");
+}
+
+int main()
+{
+	vectors();
+	strings();
+	hooks();
+	return bench::finish();
+}
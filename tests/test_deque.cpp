@@ -0,0 +1,141 @@
+// deque: pushing one of its own elements across a reallocation,
+// wraparound, growth while wrapped, iterator order
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyDeque.h"
+#include <deque>
+#include <stdlib.h>
+#include <string>
+
+template <typename T> static void self_push(T const &a, T const &b)
+{
+	for (size_t n = 1; n <= 40; n++) {
+		tiny::deque<T> d;
+		for (size_t i = 0; i < n; i++) {
+			d.push_back(i & 1 ? a : b);
+		}
+		d.pop_front();
+		d.push_back(a);
+		d.push_back(d.front());
+		bench::check(d.back() == d.front(), "push_back(front())");
+		d.push_front(d.back());
+		bench::check(d.front() == d.back(), "push_front(back())");
+		for (size_t i = 0; i < 20; i++) {
+			d.push_front(d[d.size() / 2]);
+			d.push_back(d[d.size() / 2]);
+		}
+		bench::check(d.size() == n + 2 + 40, "size");
+	}
+}
+
+static bool same(tiny::deque<int> const &d, std::deque<int> const &e)
+{
+	if (d.size() != e.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < e.size(); i++) {
+		if (d[i] != e[i]) {
+			return false;
+		}
+	}
+	size_t i = 0;
+	for (tiny::deque<int>::const_iterator it = d.begin(); it != d.end(); it++, i++) {
+		if (*it != e[i]) {
+			return false;
+		}
+	}
+	for (tiny::deque<int>::const_reverse_iterator it = d.rbegin(); it != d.rend(); it++) {
+		if (*it != e[--i]) {
+			return false;
+		}
+	}
+	return e.empty() || (d.front() == e.front() && d.back() == e.back());
+}
+
+static void wraparound()
+{
+	// the head walks around a buffer that never grows
+	tiny::deque<int> d;
+	std::deque<int> e;
+	d.reserve(8);
+	for (int i = 0; i < 6; i++) {
+		d.push_back(i);
+		e.push_back(i);
+	}
+	for (int i = 0; i < 100; i++) {
+		d.pop_front();
+		e.pop_front();
+		d.push_back(i);
+		e.push_back(i);
+		if (!same(d, e)) break;
+	}
+	bench::check(same(d, e), "push_back and pop_front around the buffer");
+
+	// grows while the elements wrap past the end of the buffer
+	tiny::deque<int> w;
+	std::deque<int> f;
+	for (int i = 0; i < 5; i++) {
+		w.push_back(i);
+		f.push_back(i);
+	}
+	for (int i = 0; i < 3; i++) {
+		w.push_front(-i);
+		f.push_front(-i);
+	}
+	for (int i = 0; i < 100; i++) {
+		w.push_front(i);
+		f.push_front(i);
+		w.push_back(i);
+		f.push_back(i);
+	}
+	bench::check(same(w, f), "growth while wrapped");
+
+	// random pushes and pops at both ends
+	srand(1);
+	for (int i = 0; i < 20000; i++) {
+		int r = rand() % 5;
+		if (r == 0 && !f.empty()) {
+			w.pop_back();
+			f.pop_back();
+		} else if (r == 1 && !f.empty()) {
+			w.pop_front();
+			f.pop_front();
+		} else if (r < 4) {
+			w.push_front(i);
+			f.push_front(i);
+		} else {
+			w.push_back(i);
+			f.push_back(i);
+		}
+	}
+	bench::check(same(w, f), "random pushes and pops at both ends");
+	while (!f.empty()) {
+		w.pop_back();
+		f.pop_back();
+	}
+	bench::check(w.empty() && same(w, f), "popped to empty");
+}
+
+static void iterator_order()
+{
+	tiny::deque<int> d;
+	for (int i = 0; i < 4; i++) {
+		d.push_back(i);
+	}
+	bench::check(d.begin() < d.end() && d.end() > d.begin() && d.begin() <= d.begin(), "iterator order");
+	bench::check(d.rbegin() < d.rend() && d.rend() > d.rbegin() && d.rend() >= d.rend(), "reverse iterator order");
+	bench::check(d.end() - d.begin() == 4 && d.rend() - d.rbegin() == 4, "iterator distance");
+	// positions whose difference does not fit an int; only compared
+	size_t far = (size_t)-1 / 2 + 1;
+	bench::check(d.begin() < d.begin() + far && !(d.begin() + far < d.begin()), "order of distant iterators");
+	bench::check(d.rend() - far < d.rend() && d.rend() > d.rend() - far, "order of distant reverse iterators");
+}
+
+int main()
+{
+	wraparound();
+	iterator_order();
+	self_push<int>(1, 2);
+	self_push<std::string>(std::string(40, 'a'), std::string(40, 'b'));
+	return bench::finish();
+}
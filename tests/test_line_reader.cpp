@@ -0,0 +1,142 @@
+// line_reader: LF and CRLF lines, lines longer than the buffer, a last
+// line without a newline, sources that have nothing yet, next_block, and
+// a zero capacity
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyLineReader.h"
+#include <string.h>
+#include <string>
+#include <vector>
+
+typedef tiny::line_reader<tiny::memory_source> reader_t;
+
+// hands out its bytes in pieces, with nothing available in between, so
+// that the reader sees NEED_MORE
+class trickle_source {
+private:
+	char const *ptr;
+	size_t left;
+	size_t piece;
+	bool starve;
+public:
+	trickle_source(char const *text, size_t piece)
+		: ptr(text)
+		, left(strlen(text))
+		, piece(piece)
+		, starve(true)
+	{
+	}
+	int read(char *buf, size_t n)
+	{
+		starve = !starve;
+		if (starve) return 0;
+		if (left == 0) return -1;
+		if (n > piece) n = piece;
+		if (n > left) n = left;
+		memcpy(buf, ptr, n);
+		ptr += n;
+		left -= n;
+		return (int)n;
+	}
+};
+
+static std::string str(tiny::string_view const &v)
+{
+	return std::string(v.data(), v.size());
+}
+
+// every status and record until END, as "R:text", "P:text", "N"
+template <typename R> static std::vector<std::string> drain(R &r)
+{
+	std::vector<std::string> out;
+	tiny::string_view v;
+	for (int guard = 0; guard < 1000; guard++) {
+		typename R::status s = r.next(&v);
+		if (s == R::END) break;
+		if (s == R::NEED_MORE) {
+			out.push_back("N");
+		} else {
+			out.push_back((s == R::RECORD ? "R:" : "P:") + str(v));
+		}
+	}
+	return out;
+}
+
+static bool records(std::vector<std::string> const &got, char const *const *expect, size_t n)
+{
+	std::vector<std::string> r;
+	for (size_t i = 0; i < got.size(); i++) {
+		if (got[i] != "N") r.push_back(got[i]);
+	}
+	if (r.size() != n) return false;
+	for (size_t i = 0; i < n; i++) {
+		if (r[i] != expect[i]) return false;
+	}
+	return true;
+}
+
+int main()
+{
+	{
+		char const text[] = "one\ntwo\r\n\r\nthree";
+		reader_t r(tiny::memory_source(text, strlen(text)), 16);
+		static char const *const expect[] = { "R:one", "R:two", "R:", "R:three" };
+		bench::check(r.valid() && records(drain(r), expect, 4), "LF, CRLF, empty line, last line without newline");
+		tiny::string_view v;
+		bench::check(r.next(&v) == reader_t::END, "END stays END");
+	}
+	{
+		char const text[] = "abcdefghijklmnopqrstuvwxyz\nshort\n";
+		reader_t r(tiny::memory_source(text, strlen(text)), 10);
+		static char const *const expect[] = { "P:abcdefghij", "P:klmnopqrst", "R:uvwxyz", "R:short" };
+		bench::check(records(drain(r), expect, 4), "line longer than the buffer comes as PARTIAL then RECORD");
+	}
+	{
+		// a CRLF split across pieces
+		char const text[] = "abcd\r\nefg\r\n";
+		reader_t r(tiny::memory_source(text, strlen(text)), 5);
+		static char const *const expect[] = { "P:abcd", "R:", "R:efg" };
+		bench::check(records(drain(r), expect, 3), "CRLF at the buffer boundary");
+	}
+	{
+		char const text[] = "0123456789";
+		reader_t r(tiny::memory_source(text, strlen(text)), 10);
+		static char const *const expect[] = { "P:0123456789", "R:" };
+		bench::check(records(drain(r), expect, 2), "a long last line without newline ends with an empty RECORD");
+	}
+	{
+		trickle_source src("alpha\nbeta\r\ngamma", 3);
+		tiny::line_reader<trickle_source> r(src, 8);
+		std::vector<std::string> got = drain(r);
+		static char const *const expect[] = { "R:alpha", "R:beta", "R:gamma" };
+		bool waited = false;
+		for (size_t i = 0; i < got.size(); i++) {
+			waited = waited || got[i] == "N";
+		}
+		bench::check(waited && records(got, expect, 3), "NEED_MORE while the source has nothing");
+	}
+	{
+		char const text[] = "HEADpayload-of-20-bytesTAIL";
+		reader_t r(tiny::memory_source(text, strlen(text)), 8);
+		tiny::string_view v;
+		bench::check(r.next_block(4, &v) == reader_t::RECORD && str(v) == "HEAD", "next_block within the buffer");
+		size_t left = 19;
+		std::string body;
+		reader_t::status s;
+		while ((s = r.next_block(left, &v)) == reader_t::PARTIAL) {
+			body += str(v);
+			left -= v.size();
+		}
+		body += str(v);
+		bench::check(s == reader_t::RECORD && body == "payload-of-20-bytes", "next_block larger than the buffer");
+		bench::check(r.next_block(10, &v) == reader_t::PARTIAL && str(v) == "TAIL", "next_block cut short by the end");
+		bench::check(r.next_block(1, &v) == reader_t::END, "next_block at the end");
+	}
+	{
+		char const text[] = "abc\n";
+		reader_t r(tiny::memory_source(text, strlen(text)), 0);
+		tiny::string_view v;
+		bench::check(!r.valid() && r.next(&v) == reader_t::END && r.next_block(1, &v) == reader_t::END, "zero capacity is refused");
+	}
+	return bench::finish();
+}
@@ -0,0 +1,147 @@
+// forward_list and intrusive_list: pushes, pops, insert and erase,
+// iteration, copies, and hooks unlinking themselves on destruction
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyForwardList.h"
+#include "TinyContainer/TinyIntrusiveList.h"
+#include <string>
+
+template <typename L> static bool holds(L const &l, int const *expect, size_t n)
+{
+	size_t i = 0;
+	for (typename L::const_iterator it = l.begin(); it != l.end(); it++, i++) {
+		if (i == n || *it != expect[i]) {
+			return false;
+		}
+	}
+	return i == n;
+}
+
+static void forward_lists()
+{
+	tiny::forward_list<int> l;
+	bench::check(l.empty() && l.begin() == l.end(), "empty forward_list");
+	l.push_back(2);
+	l.push_back(3);
+	l.push_front(1);
+	static const int a[] = { 1, 2, 3 };
+	bench::check(holds(l, a, 3) && l.size() == 3 && l.front() == 1 && l.back() == 3, "push_front and push_back");
+
+	tiny::forward_list<int>::iterator it = l.insert_after(l.begin() + 1, 9);
+	static const int b[] = { 1, 2, 9, 3 };
+	bench::check(holds(l, b, 4) && *it == 9, "insert_after in the middle");
+	l.insert_after(l.begin() + 3, 4);
+	static const int c[] = { 1, 2, 9, 3, 4 };
+	bench::check(holds(l, c, 5) && l.back() == 4, "insert_after the last element");
+
+	it = l.erase_after(l.begin() + 1);
+	static const int e[] = { 1, 2, 3, 4 };
+	bench::check(holds(l, e, 4) && *it == 3, "erase_after in the middle");
+	l.erase_after(l.begin() + 2);
+	bench::check(holds(l, a, 3) && l.back() == 3, "erase_after the last element");
+	bench::check(l.erase_after(l.begin() + 2) == l.end() && l.size() == 3, "erase_after with nothing after");
+	l.push_back(5);
+	bench::check(l.back() == 5 && l.size() == 4, "push_back after erasing the last element");
+
+	tiny::forward_list<int> m(l);
+	m.pop_front();
+	static const int d[] = { 2, 3, 5 };
+	bench::check(holds(m, d, 3) && l.size() == 4, "copy is independent");
+	m = l;
+	bench::check(m.size() == 4 && m.front() == 1, "assignment");
+	while (!m.empty()) {
+		m.pop_front();
+	}
+	m.pop_front();
+	bench::check(m.size() == 0 && m.begin() == m.end(), "popped to empty");
+	m.push_back(7);
+	bench::check(m.front() == 7 && m.back() == 7, "push_back into a list popped to empty");
+
+	tiny::forward_list<std::string> s;
+	for (int i = 0; i < 100; i++) {
+		s.push_back(std::string(40, (char)('a' + i % 26)));
+	}
+	size_t n = 0;
+	for (tiny::forward_list<std::string>::iterator i = s.begin(); i != s.end(); i++, n++) {
+		if ((*i)[0] != (char)('a' + n % 26)) break;
+	}
+	bench::check(n == 100 && s.size() == 100, "forward_list of strings");
+	s.clear();
+	bench::check(s.empty(), "clear");
+}
+
+// the hook is not the first member, and there is no default constructor
+struct item {
+	std::string name;
+	int value;
+	tiny::list_hook hook;
+	explicit item(int v)
+		: name("item")
+		, value(v)
+	{
+	}
+	bool operator != (int v) const
+	{
+		return value != v;
+	}
+};
+
+typedef tiny::intrusive_list<item, &item::hook> item_list;
+
+static void intrusive_lists()
+{
+	item_list l;
+	bench::check(l.empty() && l.size() == 0, "empty intrusive_list");
+	item a(1), b(2), c(3), d(4);
+	l.push_back(b);
+	l.push_back(c);
+	l.push_front(a);
+	static const int abc[] = { 1, 2, 3 };
+	bench::check(holds(l, abc, 3) && l.front().value == 1 && l.back().value == 3, "push_front and push_back");
+	bench::check(&*item_list::iterator_to(b) == &b && item_list::iterator_to(b)->value == 2, "iterator_to");
+
+	l.insert(item_list::iterator_to(c), d);
+	static const int abdc[] = { 1, 2, 4, 3 };
+	bench::check(holds(l, abdc, 4), "insert before an element");
+	l.push_back(a);
+	static const int bdca[] = { 2, 4, 3, 1 };
+	bench::check(holds(l, bdca, 4) && l.size() == 4, "pushing a linked element moves it");
+
+	item_list::iterator it = l.erase(item_list::iterator_to(d));
+	static const int bca[] = { 2, 3, 1 };
+	bench::check(holds(l, bca, 3) && it->value == 3 && !d.hook.linked(), "erase");
+	l.pop_front();
+	l.pop_back();
+	bench::check(l.size() == 1 && l.front().value == 3 && !a.hook.linked() && !b.hook.linked(), "pop_front and pop_back");
+
+	{
+		item e(5);
+		l.push_back(e);
+		bench::check(l.size() == 2, "push_back of a scoped element");
+	}
+	bench::check(l.size() == 1 && l.back().value == 3, "destroyed element unlinks itself");
+
+	item_list::iterator r = l.end();
+	r--;
+	bench::check(r->value == 3 && (l.end() - 1) == r, "iterating backward from end");
+
+	// moves between lists
+	item_list other;
+	other.push_back(c);
+	bench::check(l.empty() && other.size() == 1, "pushing into another list moves the element");
+	{
+		item_list scoped;
+		scoped.push_back(a);
+		scoped.push_back(b);
+	}
+	bench::check(!a.hook.linked() && !b.hook.linked(), "destroyed list unlinks its elements");
+	other.clear();
+	bench::check(other.empty() && !c.hook.linked(), "clear unlinks");
+}
+
+int main()
+{
+	forward_lists();
+	intrusive_lists();
+	return bench::finish();
+}
@@ -0,0 +1,64 @@
+// Strings made from a tiny::literal share it without copying; the first
+// write copies, leaving the literal and the other strings untouched.
+
+#define TINY_ALLOC_STATS
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include <string.h>
+
+static constexpr tiny::literal greeting("hello");
+
+static bool is(tiny::string const &s, char const *text)
+{
+	return s.size() == strlen(text) && strcmp(s.c_str(), text) == 0;
+}
+
+static bool literal_intact()
+{
+	return greeting.size() == 5 && strcmp(greeting.c_str(), "hello") == 0;
+}
+
+int main()
+{
+	size_t allocs = tiny::allocation_stats().allocations;
+	tiny::string a = greeting;
+	tiny::string b = greeting;
+	tiny::string c = a;
+	bench::check(tiny::allocation_stats().allocations == allocs, "sharing a literal allocates nothing");
+	bench::check(a.c_str() == greeting.c_str() && c.c_str() == greeting.c_str(), "strings point at the literal");
+
+	a.print(", world");
+	bench::check(is(a, "hello, world"), "print to a literal-backed string");
+	bench::check(literal_intact() && is(b, "hello") && is(c, "hello"), "print leaves the literal and the sharers");
+	bench::check(b.c_str() == greeting.c_str(), "sharers still point at the literal");
+
+	b.set_layout(tiny::STRING_CONTIGUOUS);
+	bench::check(b.layout() == tiny::STRING_CONTIGUOUS && is(b, "hello"), "set_layout on a literal-backed string");
+	bench::check(literal_intact() && c.layout() == tiny::STRING_AUTO && is(c, "hello"), "set_layout leaves the literal and the sharers");
+	b.print("!");
+	bench::check(is(b, "hello!") && is(c, "hello"), "print after set_layout");
+
+	c.clear();
+	bench::check(c.empty() && c.c_str()[0] == 0, "clear of a literal-backed string");
+	bench::check(literal_intact(), "clear leaves the literal");
+
+	tiny::string d = greeting;
+	tiny::string e = d;
+	e.clear();
+	bench::check(is(d, "hello") && e.empty(), "clear leaves the sharers");
+	e.print("x");
+	bench::check(is(e, "x") && is(d, "hello"), "print after clear");
+
+	tiny::string f = greeting;
+	f.reserve(100);
+	f.print(" there");
+	bench::check(is(f, "hello there") && literal_intact(), "reserve copies before writing");
+
+	tiny::string g = greeting;
+	g = a;
+	bench::check(is(g, "hello, world") && literal_intact(), "assigning over a literal-backed string");
+	g = greeting;
+	bench::check(is(g, "hello") && g.c_str() == greeting.c_str(), "assigning a literal");
+
+	return bench::finish();
+}
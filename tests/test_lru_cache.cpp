@@ -0,0 +1,155 @@
+// lru_cache: eviction order, get refreshing recency, erase among
+// colliding keys, string keys and the counters, checked against a model
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyLruCache.h"
+#include <list>
+#include <stdlib.h>
+#include <utility>
+
+// sends every key to one of three home slots, so that keys collide and
+// erase has to shift probe chains back, some of them around the end of
+// the table
+struct colliding_hash {
+	size_t operator () (int k) const
+	{
+		return (size_t)(k % 3) * 5 + 12;
+	}
+};
+
+// least recently used at the back
+typedef std::list<std::pair<int, int> > model_t;
+
+static std::pair<int, int> *model_find(model_t &m, int k)
+{
+	for (model_t::iterator it = m.begin(); it != m.end(); it++) {
+		if (it->first == k) return &*it;
+	}
+	return 0;
+}
+
+static void model_touch(model_t &m, int k)
+{
+	for (model_t::iterator it = m.begin(); it != m.end(); it++) {
+		if (it->first == k) {
+			m.splice(m.begin(), m, it);
+			return;
+		}
+	}
+}
+
+template <typename C> static bool agrees(C const &c, model_t const &m)
+{
+	if (c.size() != m.size()) return false;
+	for (model_t::const_iterator it = m.begin(); it != m.end(); it++) {
+		int const *v = c.peek(it->first);
+		if (!v || *v != it->second) return false;
+	}
+	return true;
+}
+
+template <typename Hash> static void random_ops(char const *name)
+{
+	tiny::lru_cache<int, int, 16, Hash> c;
+	model_t m;
+	unsigned long hits = 0, misses = 0, evictions = 0;
+	srand(1);
+	bool ok = true;
+	for (int i = 0; i < 50000 && ok; i++) {
+		int k = rand() % 40;
+		int r = rand() % 4;
+		if (r == 0) {
+			bool erased = model_find(m, k) != 0;
+			for (model_t::iterator it = m.begin(); it != m.end(); it++) {
+				if (it->first == k) {
+					m.erase(it);
+					break;
+				}
+			}
+			ok = ok && c.erase(k) == erased;
+		} else if (r == 1) {
+			int *v = c.get(k);
+			std::pair<int, int> *p = model_find(m, k);
+			ok = ok && (v != 0) == (p != 0) && (!v || *v == p->second);
+			if (p) {
+				hits++;
+				model_touch(m, k);
+			} else {
+				misses++;
+			}
+		} else {
+			c.put(k, i);
+			if (std::pair<int, int> *p = model_find(m, k)) {
+				p->second = i;
+				model_touch(m, k);
+			} else {
+				if (m.size() == 16) {
+					m.pop_back();
+					evictions++;
+				}
+				m.push_front(std::make_pair(k, i));
+			}
+		}
+		ok = ok && agrees(c, m);
+		for (int j = 0; j < 40 && ok; j++) {
+			ok = c.contains(j) == (model_find(m, j) != 0);
+		}
+	}
+	bench::check(ok, name);
+	bench::check(c.hits() == hits && c.misses() == misses && c.evictions() == evictions, "counters");
+}
+
+int main()
+{
+	tiny::lru_cache<int, int, 3> c;
+	c.put(1, 10);
+	c.put(2, 20);
+	c.put(3, 30);
+	c.put(4, 40);
+	bench::check(!c.contains(1) && c.size() == 3 && c.evictions() == 1, "least recently used is evicted");
+	bench::check(c.get(2) && *c.get(2) == 20, "get");
+	c.put(5, 50);
+	bench::check(c.contains(2) && !c.contains(3), "get refreshes recency");
+	c.peek(4);
+	c.put(6, 60);
+	bench::check(!c.contains(4), "peek does not refresh recency");
+	c.put(2, 21);
+	c.put(7, 70);
+	bench::check(*c.peek(2) == 21 && !c.contains(5), "put of a present key refreshes it");
+	bench::check(c.erase(2) && !c.erase(2) && c.size() == 2, "erase");
+	c.put(8, 80);
+	bench::check(c.size() == 3 && c.contains(6) && c.contains(7) && c.contains(8), "erased entry is reused");
+	c.reset_stats();
+	c.get(6);
+	c.get(9);
+	bench::check(c.hits() == 1 && c.misses() == 1 && c.evictions() == 0, "counters after reset_stats");
+	c.clear();
+	bench::check(c.empty() && !c.contains(6) && c.get(6) == 0, "clear");
+
+	// colliding keys: erasing one must leave the others in its chain
+	// reachable
+	tiny::lru_cache<int, int, 8, colliding_hash> h;
+	for (int k = 0; k < 8; k++) {
+		h.put(k, k * 10);
+	}
+	h.erase(0);
+	h.erase(4);
+	bool found = true;
+	for (int k = 0; k < 8; k++) {
+		int const *v = h.peek(k);
+		found = found && (k == 0 || k == 4 ? v == 0 : v && *v == k * 10);
+	}
+	bench::check(found, "lookups after erasing colliding keys");
+
+	random_ops<tiny::hash<int> >("random ops");
+	random_ops<colliding_hash>("random ops with colliding keys");
+
+	tiny::lru_cache<tiny::string, int, 2> s;
+	s.put(tiny::string("alpha"), 1);
+	s.put(tiny::string("beta"), 2);
+	bench::check(s.get(tiny::string("alpha")) && *s.get(tiny::string("alpha")) == 1, "string key");
+	s.put(tiny::string("gamma"), 3);
+	bench::check(!s.contains(tiny::string("beta")) && s.contains(tiny::string("gamma")), "string key eviction");
+
+	return bench::finish();
+}
@@ -0,0 +1,120 @@
+// Every allocation the containers make is failed in turn; they must
+// report it and stay usable, never write through null.
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include "TinyContainer/TinyDeque.h"
+#include "TinyContainer/TinyForwardList.h"
+#include "TinyContainer/TinyPriorityQueue.h"
+#include "TinyContainer/TinySlotMap.h"
+#include <new>
+#include <stdlib.h>
+
+// the allocation that fails: 1 is the next one, 0 none
+static long fail_at = 0;
+
+void *operator new[](size_t n, std::nothrow_t const &) noexcept
+{
+	if (fail_at > 0 && --fail_at == 0) {
+		return 0;
+	}
+	return malloc(n ? n : 1);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+static void strings()
+{
+	tiny::string s("hello");
+	s.print(" world");
+	tiny::string t = s;
+	t.print("!");
+	tiny::string u;
+	u.set_layout(tiny::STRING_CONTIGUOUS);
+	for (int i = 0; i < 50; i++) {
+		u.print("abcdefgh");
+	}
+	s.clear();
+	t.compact();
+	bench::keep(s.c_str()[0]);
+	bench::keep(t.c_str()[0]);
+	bench::keep(u.c_str()[0]);
+	bench::check(t.size() == 0 || t.c_str()[t.size()] == 0, "string terminated");
+}
+
+static void containers()
+{
+	tiny::vector<int> v;
+	for (int i = 0; i < 40; i++) {
+		v.push_back(i);
+	}
+	v.resize(100);
+	tiny::vector<int> w(v);
+	bench::check(w.size() == v.size() || w.empty(), "vector copy");
+	tiny::list<int> l;
+	for (int i = 0; i < 10; i++) {
+		l.push_back(i);
+	}
+	tiny::list<int> l2(l);
+	tiny::forward_list<int> f;
+	for (int i = 0; i < 10; i++) {
+		f.push_back(i);
+		f.push_front(i);
+	}
+	tiny::forward_list<int> f2(f);
+	bench::check(f2.size() <= f.size(), "forward_list copy");
+	tiny::deque<int> d;
+	for (int i = 0; i < 40; i++) {
+		d.push_back(i);
+		d.push_front(i);
+	}
+	tiny::priority_queue<int> q;
+	for (int i = 0; i < 40; i++) {
+		q.push(i);
+	}
+	size_t n = q.size();
+	size_t popped = 0;
+	while (!q.empty()) {
+		q.pop();
+		popped++;
+	}
+	bench::check(popped == n, "priority_queue consistent");
+}
+
+static void slot_maps()
+{
+	tiny::slot_map<int> m;
+	tiny::slot_map<int>::handle_t handles[40];
+	size_t nh = 0;
+	for (int i = 0; i < 40; i++) {
+		tiny::slot_map<int>::handle_t h = m.insert(i);
+		if (m.contains(h)) {
+			handles[nh++] = h;
+		}
+		if (i % 3 == 0 && nh > 0) {
+			m.erase(handles[--nh]);
+		}
+	}
+	bool found = m.size() == nh;
+	for (size_t i = 0; i < nh; i++) {
+		found = found && m.find(handles[i]) && *m.find(handles[i]) == m[handles[i]];
+	}
+	bench::check(found, "slot_map consistent");
+}
+
+int main()
+{
+	for (long k = 1; k < 200; k++) {
+		fail_at = k;
+		strings();
+		fail_at = k;
+		containers();
+		fail_at = k;
+		slot_maps();
+	}
+	fail_at = 0;
+	return bench::finish();
+}
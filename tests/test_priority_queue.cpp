@@ -0,0 +1,37 @@
+// priority_queue as a timer queue: earliest deadline first
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyPriorityQueue.h"
+#include <stdlib.h>
+
+int main()
+{
+	tiny::priority_queue<unsigned long, tiny::greater> timers;
+	tiny::vector<tiny::priority_queue<unsigned long, tiny::greater>::handle_t> handles;
+	srand(2);
+	for (int i = 0; i < 1000; i++) {
+		handles.push_back(timers.push(1000 + rand() % 100000));
+		bench::check(handles[i] != timers.npos, "push");
+	}
+	// move some deadlines earlier and some later
+	for (int i = 0; i < 1000; i += 3) {
+		timers.update(handles[i], rand() % 200000);
+	}
+	unsigned long last = 0;
+	size_t n = 0;
+	while (!timers.empty()) {
+		bench::check(timers.top() >= last, "min-heap order");
+		last = timers.top();
+		timers.pop();
+		n++;
+	}
+	bench::check(n == 1000, "pop count");
+
+	tiny::vector<unsigned long> v;
+	for (int i = 0; i < 100; i++) {
+		v.push_back(100 - i);
+	}
+	bench::check(timers.heapify(v), "heapify");
+	bench::check(timers.top() == 1 && timers.get(99) == 1, "heapify order and handles");
+	return bench::finish();
+}
@@ -0,0 +1,83 @@
+// slot_map: insert, erase, stale handles, slot reuse and clear, checked
+// against a plain model
+
+#include "bench/bench.h"
+#include "TinyContainer/TinySlotMap.h"
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+typedef tiny::slot_map<std::string> map_t;
+
+static std::string text(int i)
+{
+	return std::string(30, (char)('a' + i % 26)) + std::to_string(i);
+}
+
+int main()
+{
+	map_t m;
+	bench::check(m.empty() && m.begin() == m.end(), "empty slot_map");
+
+	map_t::handle_t a = m.insert(text(1));
+	map_t::handle_t b = m.insert(text(2));
+	map_t::handle_t c = m.insert(text(3));
+	bench::check(m.size() == 3 && *m.find(a) == text(1) && m[b] == text(2) && m.contains(c), "insert and find");
+
+	bench::check(m.erase(a) && !m.erase(a), "erase once");
+	bench::check(!m.contains(a) && m.find(a) == 0 && m.size() == 2, "erased handle is stale");
+	bench::check(*m.find(b) == text(2) && *m.find(c) == text(3), "erase moves the last value, handles follow");
+
+	// the erased slot is reused with a new generation
+	map_t::handle_t d = m.insert(text(4));
+	bench::check(d.index == a.index && d != a, "slot reuse");
+	bench::check(!m.contains(a) && *m.find(d) == text(4), "old handle does not alias the reused slot");
+
+	size_t n = 0;
+	for (map_t::iterator it = m.begin(); it != m.end(); it++) {
+		n++;
+	}
+	bool owners = true;
+	for (size_t i = 0; i < m.size(); i++) {
+		map_t::handle_t h = m.handle_at(i);
+		owners = owners && m.find(h) == &*(m.begin() + i);
+	}
+	bench::check(n == 3 && owners, "iteration and handle_at");
+
+	m.clear();
+	bench::check(m.empty() && !m.contains(b) && !m.contains(c) && !m.contains(d), "clear makes every handle stale");
+	map_t::handle_t e = m.insert(text(5));
+	bench::check(m.size() == 1 && *m.find(e) == text(5) && !m.contains(b), "insert after clear");
+	m.clear();
+
+	// random inserts and erases against a model of live handles
+	std::vector<map_t::handle_t> live, dead;
+	std::vector<int> model;
+	srand(1);
+	bool ok = true;
+	for (int i = 0; i < 20000 && ok; i++) {
+		if (live.empty() || rand() % 3 != 0) {
+			live.push_back(m.insert(text(i)));
+			model.push_back(i);
+		} else {
+			size_t k = rand() % live.size();
+			ok = ok && m.erase(live[k]);
+			dead.push_back(live[k]);
+			live[k] = live.back();
+			live.pop_back();
+			model[k] = model.back();
+			model.pop_back();
+		}
+		if (i % 1000 == 0) {
+			for (size_t k = 0; k < live.size(); k++) {
+				ok = ok && m.find(live[k]) && *m.find(live[k]) == text(model[k]);
+			}
+			for (size_t k = 0; k < dead.size(); k++) {
+				ok = ok && !m.contains(dead[k]);
+			}
+		}
+	}
+	bench::check(ok && m.size() == live.size(), "random inserts and erases");
+
+	return bench::finish();
+}
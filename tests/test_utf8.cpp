@@ -0,0 +1,156 @@
+// utf8: validate, next, code_points, encode and to_utf16, and strings of
+// char16_t and wchar_t
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyUtf8.h"
+#include <string.h>
+#include <string>
+
+using namespace tiny;
+
+static bool valid(std::string const &s)
+{
+	return utf8::validate(s.data(), s.size());
+}
+
+// s placed at each offset in ASCII padding, so that it falls on and
+// around the 8 and 16 byte fast path boundaries
+static bool valid_everywhere(std::string const &s, bool expect)
+{
+	for (size_t pre = 0; pre <= 33; pre++) {
+		for (size_t post = 0; post <= 17; post += 17) {
+			std::string t = std::string(pre, 'a') + s + std::string(post, 'b');
+			if (valid(t) != expect) return false;
+		}
+	}
+	return true;
+}
+
+static void validation()
+{
+	bench::check(valid("") && valid("plain ascii text, longer than sixteen bytes"), "ASCII");
+	bench::check(valid_everywhere("\xc3\xa9", true), "two byte sequence");
+	bench::check(valid_everywhere("\xe2\x82\xac", true), "three byte sequence");
+	bench::check(valid_everywhere("\xf0\x9f\x98\x80", true), "four byte sequence");
+	bench::check(valid_everywhere("\xf4\x8f\xbf\xbf", true), "U+10FFFF");
+	bench::check(valid_everywhere("\xed\x9f\xbf\xee\x80\x80", true), "around the surrogates");
+
+	bench::check(valid_everywhere("\xc0\x80", false) && valid_everywhere("\xc1\xbf", false), "overlong two byte");
+	bench::check(valid_everywhere("\xe0\x80\x80", false) && valid_everywhere("\xe0\x9f\xbf", false), "overlong three byte");
+	bench::check(valid_everywhere("\xf0\x80\x80\x80", false) && valid_everywhere("\xf0\x8f\xbf\xbf", false), "overlong four byte");
+	bench::check(valid_everywhere("\xed\xa0\x80", false) && valid_everywhere("\xed\xbf\xbf", false), "surrogates");
+	bench::check(valid_everywhere("\xf4\x90\x80\x80", false) && valid_everywhere("\xf5\x80\x80\x80", false), "past U+10FFFF");
+	bench::check(valid_everywhere("\xff", false) && valid_everywhere("\x80", false), "stray bytes");
+	bench::check(valid_everywhere("\xe2\x82", false) && valid_everywhere("\xf0\x9f\x98", false), "truncated");
+	bench::check(valid_everywhere("\xe2\x41\x82", false), "ASCII inside a sequence");
+
+	// a sequence cut by the end of the input, right where the fast path
+	// would load 8 or 16 bytes
+	for (size_t pre = 5; pre <= 17; pre++) {
+		std::string t = std::string(pre, 'a') + "\xf0\x9f\x98\x80";
+		bool ok = valid(t);
+		for (size_t cut = 1; cut < 4; cut++) {
+			ok = ok && !utf8::validate(t.data(), t.size() - cut);
+		}
+		bench::check(ok, "truncated at the end after ASCII");
+	}
+
+	// every code point round trips through encode, validate and next
+	bool round = true;
+	for (utf8::code_point cp = 0; cp < 0x110000 && round; cp++) {
+		if (cp >= 0xd800 && cp < 0xe000) continue;
+		char buf[4];
+		size_t n = utf8::encode(cp, buf);
+		char const *p = buf;
+		round = utf8::validate(buf, n) && utf8::next(&p, buf + n) == cp && p == buf + n;
+	}
+	bench::check(round, "every code point round trips");
+	char buf[4];
+	bench::check(utf8::encode(0xd800, buf) == 3 && memcmp(buf, "\xef\xbf\xbd", 3) == 0, "encode of a surrogate gives U+FFFD");
+	bench::check(utf8::encode(0x110000, buf) == 3 && memcmp(buf, "\xef\xbf\xbd", 3) == 0, "encode past U+10FFFF gives U+FFFD");
+}
+
+static void decoding()
+{
+	// invalid bytes decode one at a time as U+FFFD
+	static const char text[] = "a\xc3\xa9\xff\xe2\x82\xac\xe2\x82z";
+	static const utf8::code_point expect[] = { 'a', 0xe9, utf8::REPLACEMENT, 0x20ac, utf8::REPLACEMENT, utf8::REPLACEMENT, 'z' };
+	size_t i = 0;
+	bool ok = true;
+	for (utf8::iterator it = utf8::code_points(text).begin(), e = utf8::code_points(text).end(); it != e; it++, i++) {
+		ok = ok && i < 7 && *it == expect[i];
+	}
+	bench::check(ok && i == 7, "code_points with invalid bytes");
+	bench::check(utf8::length(text, strlen(text)) == 7, "length");
+
+	string s("\xf0\x9f\x98\x80x");
+	utf8::code_points cps(s);
+	utf8::iterator it = cps.begin();
+	bench::check(*it == 0x1f600 && it.get() == s.c_str(), "code_points of a string");
+	it++;
+	bench::check(*it == 'x' && it.get() == s.c_str() + 4, "iterator position");
+	it++;
+	bench::check(it == cps.end(), "iterator end");
+
+	char const *p = text + 1;
+	bench::check(utf8::next(&p, text + 3) == 0xe9 && p == text + 3, "next");
+	p = text + 1;
+	bench::check(utf8::next(&p, text + 2) == utf8::REPLACEMENT && p == text + 2, "next with the sequence cut by end");
+}
+
+static void utf16()
+{
+	static const char text[] = "ab\xc3\xa9\xf0\x9f\x98\x80" "cdefghijklmnop\xff";
+	size_t n = strlen(text);
+	// a, b, U+00E9, surrogate pair, 14 ASCII, U+FFFD
+	size_t need = utf8::to_utf16(text, n, 0, 0);
+	bench::check(need == 2 + 1 + 2 + 14 + 1, "measure mode");
+
+	char16_t out[32];
+	bench::check(utf8::to_utf16(text, n, out, 32) == need, "convert");
+	bench::check(out[0] == 'a' && out[2] == 0xe9 && out[3] == 0xd83d && out[4] == 0xde00, "surrogate pair");
+	bench::check(out[5] == 'c' && out[18] == 'p' && out[19] == 0xfffd, "ASCII run and U+FFFD");
+
+	// the pair does not fit: nothing of it is written, and no more after
+	char16_t small[4];
+	for (int i = 0; i < 4; i++) small[i] = 0x1234;
+	bench::check(utf8::to_utf16(text, n, small, 4) == need, "short buffer still measures");
+	bench::check(small[0] == 'a' && small[2] == 0xe9 && small[3] == 0x1234, "surrogate pair that does not fit is not split");
+
+	// cap falls inside an 8 byte ASCII run
+	char16_t mid[10];
+	for (int i = 0; i < 10; i++) mid[i] = 0x1234;
+	utf8::to_utf16(text, n, mid, 9);
+	bench::check(mid[5] == 'c' && mid[8] == 'f' && mid[9] == 0x1234, "cap inside an ASCII run");
+
+	t_stringbuffer<char16_t> w = utf8::to_utf16(string_view(text, n));
+	bench::check(w.size() == need && w.c_str()[3] == 0xd83d && w.c_str()[need] == 0, "to_utf16 into a string");
+	bench::check(utf8::to_utf16(string_view("")).size() == 0, "to_utf16 of nothing");
+}
+
+static void wide_strings()
+{
+	t_stringbuffer<char16_t> a;
+	static const char16_t hello[] = { 'h', 'i', 0 };
+	a.print(hello);
+	a.print(hello);
+	bench::check(a.size() == 4 && a.c_str()[3] == 'i' && a.c_str()[4] == 0, "t_stringbuffer<char16_t>");
+	t_stringbuffer<char16_t> e;
+	bench::check(e.size() == 0 && e.c_str()[0] == 0, "empty t_stringbuffer<char16_t>");
+
+	t_stringbuffer<wchar_t> b(L"wide");
+	b.print(L" text");
+	bench::check(b.size() == 9 && b.c_str()[5] == L't' && b.c_str()[9] == 0, "t_stringbuffer<wchar_t>");
+	t_stringbuffer<wchar_t> c = b;
+	c.print(L"!");
+	bench::check(b.size() == 9 && c.size() == 10, "t_stringbuffer<wchar_t> copy on write");
+}
+
+int main()
+{
+	validation();
+	decoding();
+	utf16();
+	wide_strings();
+	return bench::finish();
+}
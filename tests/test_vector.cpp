@@ -0,0 +1,135 @@
+// vector: erase, erase_if and remove_duplicates, assigning from itself,
+// growth of resize, list header size
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyContainer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+template <typename T, typename S> static void self_assign(T const &a, T const &b)
+{
+	tiny::vector<T, S> v;
+	for (int i = 0; i < 10; i++) {
+		v.push_back(i & 1 ? a : b);
+	}
+	v.assign(v.begin() + 2, v.end());
+	bench::check(v.size() == 8 && v[0] == b && v[1] == a, "assign from own tail");
+	v.assign(v.begin(), v.begin() + 3);
+	bench::check(v.size() == 3 && v[2] == b, "assign from own head");
+	v.assign(20, v[1]);
+	bench::check(v.size() == 20 && v[19] == a, "assign(n, own element)");
+	v.resize(1000, v[0]);
+	bench::check(v.size() == 1000 && v[999] == a, "resize(n, own element)");
+}
+
+static int value(int i)
+{
+	return i;
+}
+
+static int value(std::string const &s)
+{
+	return atoi(s.c_str());
+}
+
+template <typename T> static T make(int i)
+{
+	return T(i);
+}
+
+template <> std::string make<std::string>(int i)
+{
+	// long enough to live on the heap
+	char buf[40];
+	snprintf(buf, sizeof(buf), "%d..............................", i);
+	return std::string(buf);
+}
+
+template <typename T> static bool equals(tiny::vector<T> const &v, int const *expect, size_t n)
+{
+	if (v.size() != n) {
+		return false;
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (value(v[i]) != expect[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T> static void fill(tiny::vector<T> *v, int const *src, size_t n)
+{
+	v->clear();
+	for (size_t i = 0; i < n; i++) {
+		v->push_back(make<T>(src[i]));
+	}
+}
+
+template <typename T> static void erase_cases()
+{
+	tiny::vector<T> v;
+	bench::check(v.erase(v.begin(), v.end()) == v.end(), "erase on an empty vector");
+	bench::check(v.erase_if([](T const &){ return true; }) == 0, "erase_if on an empty vector");
+	bench::check(v.remove_duplicates() == 0, "remove_duplicates on an empty vector");
+
+	static const int src[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	fill(&v, src, 8);
+	typename tiny::vector<T>::iterator it = v.erase(v.begin() + 2, v.begin() + 5);
+	static const int range[] = { 0, 1, 5, 6, 7 };
+	bench::check(equals(v, range, 5) && value(*it) == 5, "erase(b, e) from the middle");
+	it = v.erase(v.begin() + 3, v.end());
+	bench::check(equals(v, range, 3) && it == v.end(), "erase(b, e) to the end");
+	v.erase(v.begin(), v.begin());
+	bench::check(equals(v, range, 3), "erase of an empty range");
+	v.erase(v.begin(), v.end());
+	bench::check(v.empty(), "erase(begin, end)");
+
+	fill(&v, src, 8);
+	bench::check(v.erase_if([](T const &t){ return value(t) > 100; }) == 0 && equals(v, src, 8), "erase_if removing nothing");
+	size_t n = v.erase_if([](T const &t){ return value(t) % 3 == 0; });
+	static const int kept[] = { 1, 2, 4, 5, 7 };
+	bench::check(n == 3 && equals(v, kept, 5), "erase_if removing every third");
+	bench::check(v.erase_if([](T const &){ return true; }) == 5 && v.empty(), "erase_if removing everything");
+
+	fill(&v, src, 8);
+	bench::check(v.remove_duplicates() == 0 && equals(v, src, 8), "remove_duplicates without duplicates");
+	static const int dups[] = { 1, 1, 1, 2, 3, 3, 4, 5, 5, 5 };
+	static const int unique[] = { 1, 2, 3, 4, 5 };
+	fill(&v, dups, 10);
+	bench::check(v.remove_duplicates() == 5 && equals(v, unique, 5), "remove_duplicates with runs at both ends");
+	static const int same[] = { 9, 9, 9, 9 };
+	fill(&v, same, 4);
+	bench::check(v.remove_duplicates() == 3 && equals(v, same, 1), "remove_duplicates of one run");
+}
+
+int main()
+{
+	erase_cases<int>();
+	erase_cases<std::string>();
+
+	self_assign<int, size_t>(1, 2);
+	self_assign<std::string, size_t>(std::string(30, 'a'), std::string(30, 'b'));
+	self_assign<std::string, tiny::heap_header<uint16_t> >(std::string(30, 'a'), std::string(30, 'b'));
+
+	tiny::vector<int> v;
+	size_t reallocs = 0;
+	for (size_t i = 1; i <= 100000; i++) {
+		size_t cap = v.capacity();
+		v.resize(i);
+		reallocs += v.capacity() != cap;
+	}
+	bench::check(reallocs < 40, "resize grows geometrically");
+
+	tiny::list<int> l;
+	for (int i = 0; i < 100; i++) {
+		l.push_back(i);
+	}
+	tiny::list<int> m(l);
+	for (int i = 0; i < 50; i++) {
+		m.erase(m.begin());
+	}
+	bench::check(m.size() == 50 && *m.begin() == 50, "list copy and erase");
+	return bench::finish();
+}
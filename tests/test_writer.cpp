@@ -0,0 +1,88 @@
+// writer number formatting at its limits, and JSON and CSV escaping
+
+#include "bench/bench.h"
+#include "TinyContainer/TinyWriter.h"
+#include <float.h>
+
+struct capture {
+	char buf[256];
+	size_t len;
+	capture()
+		: len(0)
+	{
+		buf[0] = 0;
+	}
+	void write(char const *p, size_t n)
+	{
+		if (n > sizeof(buf) - 1 - len) n = sizeof(buf) - 1 - len;
+		memcpy(buf + len, p, n);
+		len += n;
+		buf[len] = 0;
+	}
+};
+
+template <typename F> static void expect(char const *want, F f)
+{
+	capture c;
+	{
+		tiny::fixed_writer<8> w(c);
+		f(w);
+	}
+	if (strcmp(c.buf, want) != 0) {
+		printf("got \"%s\", want \"%s\"\n", c.buf, want);
+		bench::check(false, want);
+	}
+}
+
+int main()
+{
+	expect("x", [](tiny::writer &w){ w.print('x'); });
+	expect("65", [](tiny::writer &w){ w.print((unsigned char)65); });
+	expect("-12", [](tiny::writer &w){ w.print(-12); });
+	expect("3.14", [](tiny::writer &w){ w.print(3.14159); });
+	expect("1.000", [](tiny::writer &w){ w.print(0.9999, 3); });
+	expect("2", [](tiny::writer &w){ w.print(1.5, 0); });
+	// more than 19 decimals are clamped to 19
+	expect("0.5000000000000000000", [](tiny::writer &w){ w.print(0.5, 19); });
+	expect("0.5000000000000000000", [](tiny::writer &w){ w.print(0.5, 40); });
+	expect("-0.2500000000000000000", [](tiny::writer &w){ w.print(-0.25, 1000); });
+	expect("nan", [](tiny::writer &w){ w.print(0.0 / 0.0, 25); });
+	// large but finite
+	expect("2000000000000000000.00", [](tiny::writer &w){ w.print(2e18); });
+	expect("-100000000000000000000.0", [](tiny::writer &w){ w.print(-1e20, 1); });
+	expect("17000000000000000000", [](tiny::writer &w){ w.print(1.7e19, 0); });
+	expect("18000000000000000000", [](tiny::writer &w){ w.print(1.8e19, 0); });
+	// all the digits, of which the leading 15 are significant
+	capture big;
+	{
+		tiny::fixed_writer<8> w(big);
+		w.print(DBL_MAX / 1e100, 0);
+	}
+	bench::check(big.len == 209 && memcmp(big.buf, "179769313486231", 15) == 0, "huge values print their digits");
+	expect("inf", [](tiny::writer &w){ w.print(DBL_MAX * 2); });
+	expect("-inf", [](tiny::writer &w){ w.print(-DBL_MAX * 2); });
+
+	// JSON
+	expect("", [](tiny::writer &w){ w.json_escape(""); });
+	expect("plain text", [](tiny::writer &w){ w.json_escape("plain text"); });
+	expect("\\\"q\\\" \\\\ /", [](tiny::writer &w){ w.json_escape("\"q\" \\ /"); });
+	expect("\\b\\f\\n\\r\\t", [](tiny::writer &w){ w.json_escape("\b\f\n\r\t"); });
+	expect("\\u0000\\u0001\\u001f", [](tiny::writer &w){ w.json_escape(tiny::string_view("\0\x01\x1f", 3)); });
+	expect("\x7f\xc3\xa9", [](tiny::writer &w){ w.json_escape("\x7f\xc3\xa9"); });
+	// plain runs longer than the 8 byte buffer, between escapes
+	expect("abcdefghijklmnop\\nqrstuvwxyz0123456\\\"", [](tiny::writer &w){ w.json_escape("abcdefghijklmnop\nqrstuvwxyz0123456\""); });
+	expect("\"\"", [](tiny::writer &w){ w.json_string(""); });
+	expect("\"say \\\"hi\\\"\\n\"", [](tiny::writer &w){ w.json_string("say \"hi\"\n"); });
+
+	// CSV
+	expect("", [](tiny::writer &w){ w.csv_field(""); });
+	expect("plain field", [](tiny::writer &w){ w.csv_field("plain field"); });
+	expect("\"a,b\"", [](tiny::writer &w){ w.csv_field("a,b"); });
+	expect("\"line\r\nbreak\"", [](tiny::writer &w){ w.csv_field("line\r\nbreak"); });
+	expect("\"cr\ronly\"", [](tiny::writer &w){ w.csv_field("cr\ronly"); });
+	expect("\"lf\nonly\"", [](tiny::writer &w){ w.csv_field("lf\nonly"); });
+	expect("\"say \"\"hi\"\"\"", [](tiny::writer &w){ w.csv_field("say \"hi\""); });
+	expect("\"\"\"\"", [](tiny::writer &w){ w.csv_field("\""); });
+	expect("\"a longer field, past the buffer, with \"\"quotes\"\" in it\"", [](tiny::writer &w){ w.csv_field("a longer field, past the buffer, with \"quotes\" in it"); });
+	return bench::finish();
+}